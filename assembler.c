@@ -7,60 +7,154 @@
   Coder: Elias Vonapartis
   Release Date: May 28, 2016
   Latest Updates: May 29, 2016
+                  Oct 19, 2026  - Output formats selected on the command line
+                                - Added the verify and merge subcommands
+                                - First pass statistics in the diagnostics
+                                - Registers no longer added at start up
+                                - Added the encoder selftest subcommand
+                                - Optional passes named on the command line
+                                - Added the peephole pass option
 */
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "assembler.h"
 #include "parser.h"
 #include "symboltable.h"
 #include "errors.h"
 #include "emit.h"
 #include "records.h"
+#include "directives.h"
 #include "secondpass.h"
+#include "srec_gen.h"
+#include "srec_load.h"
+#include "jumps.h"
+#include "peephole.h"
+
+/* Optional passes which can be named on the command line */
+struct option_el{
+  char* name;
+  unsigned char* flag;
+};
+
+static struct option_el option_list[] = {
+  {"peephole", &flag_peephole},
+  {"relax", &flag_relax},
+  {"thread", &flag_thread}
+};
 
 int main(int argc, char const *argv[]) {
+  int i;
+
   /* The following ensures file accessibility */
-  if (argc != 2){
-    printf("Format: ./assembler 'filename'\n");
+  if (argc < 2){
+    printf("Format: ./assembler 'filename' [s19] [hex] [bin] [map]"
+           " [peephole] [relax] [thread]\n"
+           "        ./assembler verify 'file.s19' [bin 'file' | asm 'file']\n"
+           "        ./assembler merge 'out.s19' 'in.s19' ['in.s19' ...]\n"
+           "        ./assembler selftest\n");
     exit(0);
   }
 
-  if((fp = fopen(argv[1], "r")) == NULL){
-    printf("File %s could not be opened\n", argv[1]);
-    exit(0);
+  if(strcmp(argv[1], "verify") == 0){
+    exit(verify_command(argc, argv));
+  }
+  if(strcmp(argv[1], "merge") == 0){
+    exit(merge_command(argc, argv));
+  }
+  if(strcmp(argv[1], "selftest") == 0){
+    exit(selftest_command());
+  }
+
+  /* Any arguments after the file name are output formats or optional passes */
+  for(i = 2; i < argc; i++){
+    if(!select_option(argv[i]) && !select_format((char* )argv[i])){
+      printf("Unknown output format or option %s\n", argv[i]);
+      exit(0);
+    }
+  }
+
+  if(assemble(argv[1])){
+    write_outputs();
+  }
+  terminate();
+  print_records();
+  exit(0);
+}
+
+/* Turns on the optional pass of the given name. Returns FALSE if unknown. */
+unsigned char select_option(const char* name){
+  unsigned i;
+
+  for(i = 0; i < sizeof(option_list) / sizeof(option_list[0]); i++){
+    if(strcmp(name, option_list[i].name) == 0){
+      *option_list[i].flag = TRUE;
+      return TRUE;
+    }
+  }
+  return FALSE;
+}
+
+/*
+  Runs both passes over the named file, leaving the result in the memory image
+  of srec_gen.c. Returns TRUE if the second pass ran. The caller is expected to
+  call terminate() once done with the image.
+*/
+unsigned char assemble(const char* name){
+  if((fp = fopen(name, "r")) == NULL){
+    printf("File %s could not be opened\n", name);
+    return FALSE;
   }
 
   initialize();
   firstpass(fp);
   print_symboltable();
+  print_statistics();
 
   if(secondpasscheck()){
+    if(flag_peephole && !peephole()){
+      return FALSE;
+    }
+    if(flag_relax && !relax_jumps()){
+      return FALSE;
+    }
+    if(flag_thread){
+      thread_jumps();
+    }
     #ifdef debug
     printf("\n--------------    Starting Second Pass    --------------\n\n");
     #endif
     print_records();
     secondpass();
+    return TRUE;
   }
-  terminate();
-  print_records();
-  exit(0);
+  return FALSE;
 }
 
 void initialize(void){
   /* Open the output file for diagnostics */
   fout = fopen("diagnostics.lis", "w");
 
-  /* Initialize the symbol table */
-  init_symboltable();
+  /* Initialize the mnemonic and directive indexes and the encoder */
+  init_inst_index();
+  init_encoder();
+  init_dir_index();
 }
 
 void terminate(void){
   clear_table();
   clear_records();
-  fclose(fp);
-  fclose(fout);
+  if(fp){
+    fclose(fp);
+    fp = NULL;
+  }
+  if(fout){
+    fclose(fout);
+    fout = NULL;
+  }
   if(srec){
     fclose(srec);
+    srec = NULL;
   }
 }
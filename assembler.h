@@ -8,7 +8,7 @@
 
   Coder: Elias Vonapartis, with code from ECED3403
   Release Date: May 28, 2016
-  Latest Updates: None
+  Latest Updates: Oct 19, 2026  - Added the optional passes
 */
 
 #define debug
@@ -22,12 +22,19 @@ int LC; // Won't declare it as unsigned short since it would be best to see
         // the value of a potential overflow.
 unsigned char flag_max_lc;
 
+/* Optional passes, turned on by name on the command line */
+unsigned char flag_peephole;  // Shorter forms of some instruction runs
+unsigned char flag_relax;     // Long form for jumps out of reach
+unsigned char flag_thread;    // Jumps to jumps sent straight on
+
 enum ADDR_MODE{REGISTER, INDEXED, RELATIVE, ABSOLUTE, INDIRECT, INDIRECT_INCR,
               IMMEDIATE, BAD_ADDR_MODE};
 enum INST_TYPE {NONE, SINGLE, DOUBLE, JUMP};
 enum BYTE_COMB {WORD, BYTE, OFFSET};
 
 /* Function declarations */
+unsigned char select_option(const char* );
+unsigned char assemble(const char* );
 void initialize(void);
 void terminate(void);
 
@@ -9,6 +9,11 @@
   Latest Updates: May 29, 2016  - Added some error messages
                                 - Added some safeguards for null tokens
                   May 31, 2016  - Fixed invalid usage of negatives
+                  Oct 19, 2026  - Literals parsed by parse_literal()
+                                - Hashed lookup of case folded directives
+                                - Labels defined through define_label()
+                                - Fixed the overflowing ASCII string buffer
+                                - String records keep their own copy
 */
 
 #include <stdio.h>
@@ -37,23 +42,48 @@ struct dir_el dir_list[] = {
   {LASTDIR, NONE, DLASTDIR} /* End of list */
 };
 
-// Linear search through dirlist, returns pointer to entry or NULL
-struct dir_el *get_dir(char *dir){
-  struct dir_el *ptr;
+// Hash index over dir_list, list index plus one with 0 marking an empty slot
+static unsigned char dir_index[DIR_SLOTS];
 
-  ptr = &dir_list[0];
+void init_dir_index(void){
+  unsigned slot;
+  unsigned i;
 
-  while(strcasecmp(ptr -> dir, LASTDIR) != 0){
-    if(strcasecmp(ptr -> dir, dir) == 0){
-      return ptr;
+  memset(dir_index, 0, sizeof(dir_index));
+  for(i = 0; dir_list[i].entry != DLASTDIR; i++){
+    slot = hash_key(dir_list[i].dir) & (DIR_SLOTS - 1);
+    while(dir_index[slot]){
+      slot = (slot + 1) & (DIR_SLOTS - 1);
     }
-    else{
-      ptr++;
+    dir_index[slot] = i + 1;
+  }
+}
+
+// Hashed search through dirlist, returns pointer to entry or NULL
+struct dir_el *get_dir_key(const struct token_key* key){
+  unsigned slot;
+  struct dir_el *ptr;
+
+  if(!key->length || key->suffix){       // Directives take no suffix
+    return NULL;
+  }
+  for(slot = key->hash & (DIR_SLOTS - 1); dir_index[slot];
+      slot = (slot + 1) & (DIR_SLOTS - 1)){
+    ptr = &dir_list[dir_index[slot] - 1];
+    if(memcmp(ptr->dir, key->name, KEY_LEN) == 0){
+      return ptr;
     }
   }
   return NULL;
 }
 
+struct dir_el *get_dir(char *dir){
+  struct token_key key;
+
+  make_key(dir, &key);
+  return get_dir_key(&key);
+}
+
 // Switch case which calls functions unique for each directive, which perform
 // further analysis on the passed record.
 void analyzedirective(char* line, struct firsttoken srctoken){
@@ -141,7 +171,7 @@ void bss(char* record, unsigned char mode){
   }
 
   // Check if bss equated to valid number
-  if((bsval = is_number(record)) != EXIT_FAIL){
+  if(parse_literal(record, &bsval) == NUM_OK){
     if(bsval < MAX_LC && bsval > 0){
       add_bss_record(bsval);
       adjustLC(bsval, INCREMENT);
@@ -158,8 +188,9 @@ void bss(char* record, unsigned char mode){
         error_count("ERROR: BSS value is too large or negative", NULL);
         return;
       }
-      add_bss_record(entry->value);
-      adjustLC(entry->value, INCREMENT);
+      bsval = entry->value;
+      add_bss_record(bsval);
+      adjustLC(bsval, INCREMENT);
     }
     else{
       error_count("ERROR: BSS value is either a REG or UNKOWN.", NULL);
@@ -172,12 +203,8 @@ void bss(char* record, unsigned char mode){
   }
 
   if(flag_first_token_label){         // BSS valid, add label if there is one
-    if(get_entry(global)){            // Subtract LC since it has been added
-      update_entry(global, (LC - bsval), LBLTYPE);
-    }
-    else{
-      add_entry(global, (LC - bsval), LBLTYPE);
-    }
+    // Subtract LC since it has been added, the BSS record is at the label
+    define_label(global, (LC - bsval), record_count() - 1);
   }
 }
 
@@ -189,19 +216,14 @@ void byte(char* record){
     return;
   }
 
-  if((byteval = is_number(record)) == EXIT_FAIL){
+  if(parse_literal(record, &byteval) != NUM_OK){
     error_count("ERROR: Byte not Equated to a Numeric Value", record);
     return;
   }
 
   if(byteval <= MAXBYTEVAL && byteval > 0){ //Check if byte val is indeed a byte
     if(flag_first_token_label){             //Add label if there is one
-      if(get_entry(global)){
-        update_entry(global, LC, LBLTYPE);
-      }
-      else{
-        add_entry(global, LC, LBLTYPE);
-      }
+      define_label(global, LC, record_count());
     }
     add_data_record(byteval, BYTE);
     adjustLC(HALFWORD, INCREMENT);
@@ -226,8 +248,9 @@ void end(char* value){
   if(value){                      //End can be followed by the starting address
     if(temp = get_entry(value)){    //If there is one, add it to global storage
       start_address = temp->value;  //for s9 record
+      start_symbol = temp->id;      //Relaxation may move it
     }
-    else if((address = is_number(value)) != EXIT_FAIL){
+    else if(parse_literal(value, &address) == NUM_OK){
       start_address = address;
     }
   }
@@ -251,23 +274,13 @@ void equ(char* value){
     return;
   }
 
-  if(entry = get_entry(global)){
-    if(entry->type != REGTYPE){
-      if((intval = is_number(value)) != EXIT_FAIL){
-        update_entry(global, intval, LBLTYPE);
-      }
-      else{
-        error_count("ERROR: Not Equating a Valid Number.", NULL);
-      }
-    }
-    else{
-      error_count("ERROR: Cannot Equate Registers.", NULL);
-    }
+  if((entry = get_entry(global)) && entry->type == REGTYPE){
+    error_count("ERROR: Cannot Equate Registers.", NULL);
   }
 
-  // At this point we know label validity, so we just add the entry to the table
-  else if((intval = is_number(value)) != EXIT_FAIL){
-    add_entry(global, intval, LBLTYPE);
+  // At this point we know label validity, so we just define it
+  else if(parse_literal(value, &intval) == NUM_OK){
+    define_label(global, intval, NO_RECORD);
   }
   else{
     error_count("ERROR: Invalid or missing equate value.", NULL);
@@ -298,7 +311,7 @@ void origin(char* record){
     add_org_record(entry->value);
     adjustLC(entry->value, EQUATE);
   }
-  else if((value = is_number(record)) != EXIT_FAIL){
+  else if(parse_literal(record, &value) == NUM_OK){
     #ifdef debug
     printf("ORIGIN with a NUMBER\n");
     #endif
@@ -320,14 +333,14 @@ void string(char* record){
   char* content;
   unsigned short i;
 
-  content = (char* )(malloc(sizeof(short)));
-  ptr = (char* )(malloc(sizeof(short)));
+  content = (char* )(malloc(LINE_LEN + 1));
 
   if(ptr = strstr(record, "\"")){                     //Find the opening quotes
     *ptr++;
     for(i = 0; ptr[i] != '"' && i != LINE_LEN; i++){  //Store till closing quotes
       content[i] = ptr[i];
     }
+    content[i] = NUL;               // srec_char() writes up to the NUL
 
     #ifdef debug
     printf("Contents of string >>%s<<\n", content);
@@ -335,14 +348,9 @@ void string(char* record){
 
     if(ptr[i] == '"'){
       if(flag_first_token_label){
-        if(get_entry(global)){
-          update_entry(global, LC, LBLTYPE);
-        }
-        else{
-          add_entry(global, LC, LBLTYPE); // Add label if there is one
-        }
+        define_label(global, LC, record_count()); // Add label if any
       }
-      add_string_record(content, i); // Add entry to second pass linked-list
+      add_string_record(content, i); // Add entry for the second pass
       adjustLC(i, INCREMENT);
     }
     else{
@@ -352,35 +360,31 @@ void string(char* record){
   else{
     error_count("ERROR: String must be enclosed in quotation marks.", NULL);
   }
+  free(content);                    // The record keeps a copy
 }
 
 void word(char* record){
   struct symbol_entry* entry;
   int wordval;
 
-  if((wordval = is_number(record)) != EXIT_FAIL){
-    if(wordval <= MAXWORDVAL && wordval >= 0){
-      add_data_record(wordval, WORD); // Add entry to second pass linked-list
-    }
-    else{
-      error_count("ERROR: Valid Word values are between 0 & FFFF(h)", record);
-      return;
-    }
+  if(parse_literal(record, &wordval) != NUM_OK){
+    error_count("ERROR: Word not Equated to a Numeric Value", record);
+    return;
+  }
+  if(wordval <= MAXWORDVAL && wordval >= 0){
+    add_data_record(wordval, WORD); // Add entry to second pass linked-list
+  }
+  else{
+    error_count("ERROR: Valid Word values are between 0 & FFFF(h)", record);
+    return;
   }
 
   if(flag_first_token_label){
-    if(entry = get_entry(global)){
-      if(entry->type != REGTYPE){
-        update_entry(global, LC, LBLTYPE);
-      }
-      else{
-        error_count("ERROR: Cannot assign word to register.", NULL);
-        return;
-      }
-    }
-    else{
-      add_entry(global, LC, LBLTYPE);
+    if((entry = get_entry(global)) && entry->type == REGTYPE){
+      error_count("ERROR: Cannot assign word to register.", NULL);
+      return;
     }
+    define_label(global, LC, record_count() - 1);
   }
 
   adjustLC(WORD, INCREMENT);
@@ -7,10 +7,11 @@
 
   Coder: Elias Vonapartis
   Release Date: May 28, 2016
-  Latest Updates: None
+  Latest Updates: Oct 19, 2026  - Directives are fixed width keys
 */
 
 #define LASTDIR     "zzz"
+#define DIR_SLOTS   32      // Power of two, over twice the directive count
 #define BYTELEN     8       // in bits
 #define MAXBYTEVAL  255     // in decimal
 #define MAXWORDVAL  65535
@@ -27,13 +28,15 @@ extern FILE* fout;
 enum DIRENTRY {ALIGN, BES, BSS, DBYTE, END, EQU, ORG, STRING, DWORD, DLASTDIR};
 
 struct dir_el{
-  char *dir;
+  char dir[KEY_LEN];        // Upper case and NUL padded, see make_key()
   enum INST_TYPE type;
   enum DIRENTRY entry;
 };
 
 /* Function Declarations */
+void init_dir_index(void);
 struct dir_el* get_dir(char *dir);
+struct dir_el* get_dir_key(const struct token_key* );
 void analyzedirective(char *, struct firsttoken);
 void align(char* );
 void bss(char* , unsigned char);
@@ -1,12 +1,16 @@
 /*
   emit.c
-  Module which contains functions that apply a union process to output contiguous
-  opcode. The code contained here was based on code provided by the ECED3403
-  class at Dalhousie University.
+  Module which contains the instruction encoder. Every mnemonic has a template
+  per width with the opcode and size bits already in place, the operand fields
+  are merged into it with masks and shifts. The union emitters the encoder was
+  based on, from code provided by the ECED3403 class at Dalhousie University,
+  are kept for the self-test.
 
   Coder: Elias Vonapartis, based on ECED3403 code
   Release Date: May 28, 2016
-  Latest Updates: None
+  Latest Updates: Oct 19, 2026  - Added the table driven encoder and selftest
+                                - Column-wise encoder for the second pass
+                                - Selftest of the emulated mnemonics
 */
 
 #include <stdio.h>
@@ -14,6 +18,7 @@
 #include <string.h>
 #include "emit.h"
 #include "instructions.h"
+#include "symboltable.h"
 
 /*
   Unions are declared first, then each function included here simply assigns the
@@ -66,3 +71,212 @@ unsigned short emit_jump(short offset, unsigned opcode){
   jo.jop.opcode = opcode;
   return jo.usjop;
 }
+
+/*
+  Fills in the encoding templates of every mnemonic, one per width. A jump or
+  an instruction without operands has the same template for both widths. The
+  emulated mnemonics use the templates of their core instruction.
+*/
+void init_encoder(void){
+  struct inst_el* instptr;
+  unsigned bw;
+
+  for(instptr = inst_list; instptr < inst_list + LISTLENGTH; instptr++){
+    if(instptr->emul.core){
+      continue;
+    }
+    for(bw = WORD; bw <= BYTE; bw++){
+      switch (instptr->type) {
+        case SINGLE:
+        instptr->encoding[bw] = instptr->opcode << SOP_SHIFT | bw << BW_SHIFT;
+        break;
+        case DOUBLE:
+        instptr->encoding[bw] = instptr->opcode << DOP_SHIFT | bw << BW_SHIFT;
+        break;
+        case JUMP:
+        instptr->encoding[bw] = instptr->opcode << JOP_SHIFT;
+        break;
+        default:
+        instptr->encoding[bw] = instptr->opcode;
+        break;
+      }
+    }
+  }
+}
+
+/* Merges the fields of an instruction into its template */
+unsigned short encode_inst(const struct inst_fields* fields){
+  switch (fields->type) {
+    case SINGLE:
+    return fields->encoding | (fields->dst & REG_MASK) << DST_SHIFT |
+           (fields->as & AS_MASK) << AS_SHIFT;
+    case DOUBLE:
+    return fields->encoding | (fields->dst & REG_MASK) << DST_SHIFT |
+           (fields->as & AS_MASK) << AS_SHIFT |
+           (fields->ad & AD_MASK) << AD_SHIFT |
+           (fields->src & REG_MASK) << SRC_SHIFT;
+    case JUMP:
+    return fields->encoding | (fields->offset & OFFSET_MASK);
+    default:
+    return fields->encoding;
+  }
+}
+
+/*
+  Encodes count instructions held column-wise, merging the fields into the
+  templates in word. The fields have to be masked already. Single operand
+  instructions and jumps have src, as and ad 0, and a jump has its offset in
+  dst. The loop has no branches so the compiler can vectorize it.
+*/
+void encode_columns(unsigned count, unsigned short* restrict word,
+                    const unsigned char* restrict src,
+                    const unsigned char* restrict as,
+                    const unsigned char* restrict ad,
+                    const unsigned short* restrict dst){
+  unsigned i;
+
+  for(i = 0; i < count; i++){
+    word[i] |= src[i] << SRC_SHIFT | ad[i] << AD_SHIFT | as[i] << AS_SHIFT |
+               dst[i] << DST_SHIFT;
+  }
+}
+
+/* Encodes one instruction through encode_columns(), for the self-test */
+unsigned short encode_row(const struct inst_fields* fields){
+  unsigned short word = fields->encoding;
+  unsigned char src = fields->type == DOUBLE ? fields->src & REG_MASK : 0;
+  unsigned char as = fields->type == SINGLE || fields->type == DOUBLE ?
+                     fields->as & AS_MASK : 0;
+  unsigned char ad = fields->type == DOUBLE ? fields->ad & AD_MASK : 0;
+  unsigned short dst = 0;
+
+  if(fields->type == JUMP){
+    dst = fields->offset & OFFSET_MASK;
+  }
+  else if(fields->type == SINGLE || fields->type == DOUBLE){
+    dst = fields->dst & REG_MASK;
+  }
+  encode_columns(1, &word, &src, &as, &ad, &dst);
+  return word;
+}
+
+/*
+  Encodes an emulated mnemonic with R5 as its operand through the template of
+  its core instruction. Returns TRUE if it gives the encoding kept in opcode.
+*/
+static unsigned char check_emulated(struct inst_el* instptr, unsigned bw){
+  const struct mode_desc* desc;
+  struct inst_fields fields;
+  struct operand reg;
+  struct operand src;
+  struct operand dst;
+  unsigned short expected = instptr->opcode | bw << BW_SHIFT;
+  char* src_text;
+  char* dst_text;
+
+  classify_operand("R5", &reg);
+  emulated_operands(&instptr->emul, "R5", &reg, &src_text, &src, &dst_text,
+                    &dst);
+  memset(&fields, 0, sizeof(fields));
+  fields.encoding = get_inst((char* )instptr->emul.core)->encoding[bw];
+  fields.type = DOUBLE;
+  desc = operand_desc(&src);
+  fields.src = desc->reg == NO_REG ? src.reg : desc->reg;
+  fields.as = desc->as;
+  desc = operand_desc(&dst);
+  fields.dst = desc->reg == NO_REG ? dst.reg : desc->reg;
+  fields.ad = desc->ad;
+  return encode_inst(&fields) == expected && encode_row(&fields) == expected;
+}
+
+/*
+  Encodes every field value of every mnemonic and width it accepts through the
+  templates and through the union emitters, counting the differences. The
+  emulated mnemonics are checked against their encoding with R5. Returns the
+  process exit status, 0 if they all agree.
+*/
+int selftest_command(void){
+  struct inst_el* instptr;
+  struct inst_fields fields;
+  unsigned short expected;
+  unsigned templates = 0;
+  unsigned checked = 0;
+  unsigned mismatches = 0;
+  unsigned before;
+  unsigned widths;
+  unsigned bw;
+  unsigned i;
+  int offset;
+
+  init_inst_index();
+  init_encoder();
+  for(instptr = inst_list; instptr < inst_list + LISTLENGTH; instptr++){
+    widths = instptr->widths | SUFFIX_W;    // No suffix means a word
+    for(bw = WORD; bw <= BYTE; bw++){
+      if(!(widths & (bw == BYTE ? SUFFIX_B : SUFFIX_W))){
+        continue;
+      }
+      templates++;
+      if(instptr->emul.core){
+        checked++;
+        if(!check_emulated(instptr, bw)){
+          mismatches++;
+          printf("selftest: %s%s does not encode as %04X\n", instptr->inst,
+                 bw == BYTE ? ".B" : "", instptr->opcode | bw << BW_SHIFT);
+        }
+        continue;
+      }
+      before = mismatches;
+      memset(&fields, 0, sizeof(fields));
+      fields.encoding = instptr->encoding[bw];
+      fields.type = instptr->type;
+
+      switch (instptr->type) {
+        case SINGLE:                      // Register and As
+        for(i = 0; i < 64; i++){
+          fields.dst = i & REG_MASK;
+          fields.as = i >> 4;
+          expected = emit_single(fields.dst, fields.as, bw, instptr->opcode);
+          mismatches += encode_inst(&fields) != expected ||
+                        encode_row(&fields) != expected;
+          checked++;
+        }
+        break;
+        case DOUBLE:                      // Dst, As, Ad and Src
+        for(i = 0; i < 2048; i++){
+          fields.dst = i & REG_MASK;
+          fields.as = (i >> 4) & AS_MASK;
+          fields.ad = (i >> 6) & AD_MASK;
+          fields.src = i >> 7;
+          expected = emit_double(fields.dst, fields.as, bw, fields.ad,
+                                 fields.src, instptr->opcode);
+          mismatches += encode_inst(&fields) != expected ||
+                        encode_row(&fields) != expected;
+          checked++;
+        }
+        break;
+        case JUMP:                        // Every 10 bit offset
+        for(offset = -512; offset < 512; offset++){
+          fields.offset = offset;
+          expected = emit_jump(offset, instptr->opcode);
+          mismatches += encode_inst(&fields) != expected ||
+                        encode_row(&fields) != expected;
+          checked++;
+        }
+        break;
+        default:
+        mismatches += encode_inst(&fields) != instptr->opcode ||
+                      encode_row(&fields) != instptr->opcode;
+        checked++;
+        break;
+      }
+      if(mismatches != before){
+        printf("selftest: %s%s template %04X does not match the emitters\n",
+               instptr->inst, bw == BYTE ? ".B" : "", instptr->encoding[bw]);
+      }
+    }
+  }
+  printf("selftest: %u templates, %u encodings checked, %u mismatches\n",
+         templates, checked, mismatches);
+  return mismatches ? 1 : 0;
+}
@@ -8,9 +8,40 @@
 
   Coder: Elias Vonapartis, with code from ECED3403
   Release Date: May 28, 2016
-  Latest Updates: None
+  Latest Updates: Oct 19, 2026  - Added the table driven encoder
+                                - Column-wise encoder for the second pass
 */
 
+#include "assembler.h"
+
+/* Fields of an instruction word, each merged as (value & MASK) << SHIFT */
+#define REG_MASK        0xF
+#define AS_MASK         0x3
+#define AD_MASK         0x1
+#define OFFSET_MASK     0x3FF
+#define DST_SHIFT       0       // Register of a single operand instruction too
+#define AS_SHIFT        4
+#define BW_SHIFT        6
+#define AD_SHIFT        7
+#define SRC_SHIFT       8
+#define SOP_SHIFT       7       // Opcode of a single operand instruction
+#define DOP_SHIFT       12      // Opcode of a double operand instruction
+#define JOP_SHIFT       10      // Opcode of a jump
+
+/*
+  Decoded fields of one instruction, ready to be merged into the template of
+  its mnemonic and width. A single operand instruction has its register in dst.
+*/
+struct inst_fields{
+  unsigned short encoding;    // Template, see init_encoder()
+  enum INST_TYPE type;
+  unsigned char src;
+  unsigned char as;
+  unsigned char ad;
+  unsigned char dst;
+  short offset;               // Word offset of a jump
+};
+
 struct single_op{
   unsigned reg: 4;
   unsigned as: 2;
@@ -32,6 +63,11 @@ struct jump_op{
   unsigned opcode: 6;
 };
 
+/*
+  The bitfield emitters below were the encoder. They depend on the compiler
+  laying out bitfields from the least significant bit and are kept only as the
+  reference the templates are checked against by selftest_command().
+*/
 /* Declarations */
 unsigned short emit_single(unsigned, unsigned, unsigned, unsigned);
 unsigned short emit_double(unsigned, unsigned, unsigned, unsigned, unsigned, unsigned);
@@ -39,6 +75,15 @@ unsigned short emit_jump(short, unsigned);
 void emit_inst(void);
 unsigned short emit_data(unsigned short, unsigned short);
 unsigned short emit_string(unsigned short, char* );
+void init_encoder(void);
+unsigned short encode_inst(const struct inst_fields* );
+void encode_columns(unsigned , unsigned short* restrict ,
+                    const unsigned char* restrict ,
+                    const unsigned char* restrict ,
+                    const unsigned char* restrict ,
+                    const unsigned short* restrict );
+unsigned short encode_row(const struct inst_fields* );
+int selftest_command(void);
 
 
 #endif /* EMIT_H */
@@ -0,0 +1,308 @@
+/*
+  hexcodec.c
+  Kernels turning bytes into uppercase hex characters and back, and summing
+  bytes for record checksums. On x86 an SSE2 or AVX2 version is picked at startup from
+  what the processor supports, otherwise the portable scalar version is used.
+  All versions produce the same output.
+
+  Coder: Elias Vonapartis
+  Release Date: Oct 19, 2026
+  Latest Updates: Oct 19, 2026  - Added hex_decode() for the loader
+*/
+
+#include <stdio.h>
+#include "hexcodec.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HEX_X86
+#include <immintrin.h>
+#endif
+
+static const char hex_digits[] = "0123456789ABCDEF";
+
+typedef void (*encode_fn)(const unsigned char* , unsigned , char* );
+typedef unsigned (*sum_fn)(const unsigned char* , unsigned );
+typedef int (*decode_fn)(const char* , unsigned , unsigned char* );
+
+static void encode_scalar(const unsigned char* , unsigned , char* );
+static unsigned sum_scalar(const unsigned char* , unsigned );
+static int decode_scalar(const char* , unsigned , unsigned char* );
+
+static encode_fn encode_kernel = encode_scalar;
+static sum_fn sum_kernel = sum_scalar;
+static decode_fn decode_kernel = decode_scalar;
+static const char* kernel_name = "scalar";
+
+/*
+  Scalar versions, also used for the tails of the vector versions
+*/
+static void encode_scalar(const unsigned char* src, unsigned n, char* dst){
+  unsigned i;
+
+  for(i = 0; i < n; i++){
+    dst[2*i] = hex_digits[src[i] >> 4];
+    dst[2*i + 1] = hex_digits[src[i] & 0x0F];
+  }
+}
+
+static unsigned sum_scalar(const unsigned char* src, unsigned n){
+  unsigned sum = 0;
+  unsigned i;
+
+  for(i = 0; i < n; i++){
+    sum += src[i];
+  }
+  return sum;
+}
+
+/* Value of one hex character, or -1 for anything else */
+static int hex_value(char c){
+  if(c >= '0' && c <= '9'){
+    return c - '0';
+  }
+  if(c >= 'A' && c <= 'F'){
+    return c - 'A' + 10;
+  }
+  if(c >= 'a' && c <= 'f'){
+    return c - 'a' + 10;
+  }
+  return -1;
+}
+
+static int decode_scalar(const char* src, unsigned n, unsigned char* dst){
+  int hi, lo;
+  unsigned i;
+
+  for(i = 0; i < n; i++){
+    hi = hex_value(src[2*i]);
+    lo = hex_value(src[2*i + 1]);
+    if(hi < 0 || lo < 0){
+      return 0;
+    }
+    dst[i] = (hi << 4) | lo;
+  }
+  return 1;
+}
+
+#ifdef HEX_X86
+/*
+  Each nibble n becomes '0' + n, plus 7 more when n > 9 to reach 'A'. The high
+  and low nibbles are then interleaved so every byte gives two characters.
+*/
+__attribute__((target("sse2")))
+static __m128i nibbles_to_ascii_sse2(__m128i nib){
+  __m128i letters = _mm_and_si128(_mm_cmpgt_epi8(nib, _mm_set1_epi8(9)),
+                                  _mm_set1_epi8(7));
+  return _mm_add_epi8(_mm_add_epi8(nib, _mm_set1_epi8('0')), letters);
+}
+
+__attribute__((target("sse2")))
+static void encode_sse2(const unsigned char* src, unsigned n, char* dst){
+  const __m128i low_mask = _mm_set1_epi8(0x0F);
+  __m128i bytes, hi, lo;
+  unsigned i = 0;
+
+  for(; i + 16 <= n; i += 16){
+    bytes = _mm_loadu_si128((const __m128i* )(src + i));
+    hi = nibbles_to_ascii_sse2(_mm_and_si128(_mm_srli_epi16(bytes, 4),
+                                             low_mask));
+    lo = nibbles_to_ascii_sse2(_mm_and_si128(bytes, low_mask));
+    _mm_storeu_si128((__m128i* )(dst + 2*i), _mm_unpacklo_epi8(hi, lo));
+    _mm_storeu_si128((__m128i* )(dst + 2*i + 16), _mm_unpackhi_epi8(hi, lo));
+  }
+  encode_scalar(src + i, n - i, dst + 2*i);
+}
+
+// Sum of absolute differences against zero adds up eight bytes per lane
+__attribute__((target("sse2")))
+static unsigned sum_sse2(const unsigned char* src, unsigned n){
+  __m128i acc = _mm_setzero_si128();
+  unsigned i = 0;
+
+  for(; i + 16 <= n; i += 16){
+    acc = _mm_add_epi64(acc, _mm_sad_epu8(_mm_loadu_si128(
+                             (const __m128i* )(src + i)), _mm_setzero_si128()));
+  }
+  return _mm_cvtsi128_si32(acc) + _mm_cvtsi128_si32(_mm_srli_si128(acc, 8)) +
+         sum_scalar(src + i, n - i);
+}
+
+/*
+  Characters become nibbles as c - '0' for digits and (c | 0x20) - 'a' + 10 for
+  letters, the unsigned range checks flagging anything else. Each 16-bit lane
+  then holds a high and a low nibble which are merged and packed into bytes.
+*/
+__attribute__((target("sse2")))
+static __m128i ascii_to_pairs_sse2(__m128i chars, __m128i* bad){
+  __m128i digit = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+  __m128i letter = _mm_sub_epi8(_mm_or_si128(chars, _mm_set1_epi8(0x20)),
+                                _mm_set1_epi8('a'));
+  __m128i is_digit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)),
+                                    digit);
+  __m128i is_letter = _mm_cmpeq_epi8(_mm_min_epu8(letter, _mm_set1_epi8(5)),
+                                     letter);
+  __m128i nib = _mm_or_si128(_mm_and_si128(is_digit, digit),
+                _mm_and_si128(is_letter, _mm_add_epi8(letter,
+                                                      _mm_set1_epi8(10))));
+
+  *bad = _mm_or_si128(*bad, _mm_andnot_si128(_mm_or_si128(is_digit, is_letter),
+                                             _mm_set1_epi8(-1)));
+  return _mm_or_si128(_mm_slli_epi16(_mm_and_si128(nib, _mm_set1_epi16(0xFF)),
+                                     4), _mm_srli_epi16(nib, 8));
+}
+
+__attribute__((target("sse2")))
+static int decode_sse2(const char* src, unsigned n, unsigned char* dst){
+  __m128i bad = _mm_setzero_si128();
+  __m128i first, second;
+  unsigned i = 0;
+
+  for(; i + 16 <= n; i += 16){
+    first = ascii_to_pairs_sse2(_mm_loadu_si128((const __m128i* )(src + 2*i)),
+                                &bad);
+    second = ascii_to_pairs_sse2(_mm_loadu_si128((const __m128i* )
+                                 (src + 2*i + 16)), &bad);
+    _mm_storeu_si128((__m128i* )(dst + i), _mm_packus_epi16(first, second));
+  }
+  if(_mm_movemask_epi8(bad)){
+    return 0;
+  }
+  return decode_scalar(src + 2*i, n - i, dst + i);
+}
+
+__attribute__((target("avx2")))
+static __m256i nibbles_to_ascii_avx2(__m256i nib){
+  __m256i letters = _mm256_and_si256(_mm256_cmpgt_epi8(nib,
+                                     _mm256_set1_epi8(9)), _mm256_set1_epi8(7));
+  return _mm256_add_epi8(_mm256_add_epi8(nib, _mm256_set1_epi8('0')), letters);
+}
+
+/*
+  The 256-bit unpacks work within each 128-bit lane, so the two halves are
+  swapped back into order before storing.
+*/
+__attribute__((target("avx2")))
+static void encode_avx2(const unsigned char* src, unsigned n, char* dst){
+  const __m256i low_mask = _mm256_set1_epi8(0x0F);
+  __m256i bytes, hi, lo, first, second;
+  unsigned i = 0;
+
+  for(; i + 32 <= n; i += 32){
+    bytes = _mm256_loadu_si256((const __m256i* )(src + i));
+    hi = nibbles_to_ascii_avx2(_mm256_and_si256(_mm256_srli_epi16(bytes, 4),
+                                                low_mask));
+    lo = nibbles_to_ascii_avx2(_mm256_and_si256(bytes, low_mask));
+    first = _mm256_unpacklo_epi8(hi, lo);
+    second = _mm256_unpackhi_epi8(hi, lo);
+    _mm256_storeu_si256((__m256i* )(dst + 2*i),
+                        _mm256_permute2x128_si256(first, second, 0x20));
+    _mm256_storeu_si256((__m256i* )(dst + 2*i + 32),
+                        _mm256_permute2x128_si256(first, second, 0x31));
+  }
+  encode_sse2(src + i, n - i, dst + 2*i);
+}
+
+__attribute__((target("avx2")))
+static unsigned sum_avx2(const unsigned char* src, unsigned n){
+  __m256i acc = _mm256_setzero_si256();
+  __m128i half;
+  unsigned i = 0;
+
+  for(; i + 32 <= n; i += 32){
+    acc = _mm256_add_epi64(acc, _mm256_sad_epu8(_mm256_loadu_si256(
+                          (const __m256i* )(src + i)), _mm256_setzero_si256()));
+  }
+  half = _mm_add_epi64(_mm256_castsi256_si128(acc),
+                       _mm256_extracti128_si256(acc, 1));
+  return _mm_cvtsi128_si32(half) + _mm_cvtsi128_si32(_mm_srli_si128(half, 8)) +
+         sum_sse2(src + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static __m256i ascii_to_pairs_avx2(__m256i chars, __m256i* bad){
+  __m256i digit = _mm256_sub_epi8(chars, _mm256_set1_epi8('0'));
+  __m256i letter = _mm256_sub_epi8(_mm256_or_si256(chars,
+                                   _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+  __m256i is_digit = _mm256_cmpeq_epi8(_mm256_min_epu8(digit,
+                                       _mm256_set1_epi8(9)), digit);
+  __m256i is_letter = _mm256_cmpeq_epi8(_mm256_min_epu8(letter,
+                                        _mm256_set1_epi8(5)), letter);
+  __m256i nib = _mm256_or_si256(_mm256_and_si256(is_digit, digit),
+                _mm256_and_si256(is_letter, _mm256_add_epi8(letter,
+                                                     _mm256_set1_epi8(10))));
+
+  *bad = _mm256_or_si256(*bad, _mm256_andnot_si256(_mm256_or_si256(is_digit,
+                                      is_letter), _mm256_set1_epi8(-1)));
+  return _mm256_or_si256(_mm256_slli_epi16(_mm256_and_si256(nib,
+                         _mm256_set1_epi16(0xFF)), 4), _mm256_srli_epi16(nib, 8));
+}
+
+// The 256-bit pack works within lanes, so the 64-bit quarters are reordered
+__attribute__((target("avx2")))
+static int decode_avx2(const char* src, unsigned n, unsigned char* dst){
+  __m256i bad = _mm256_setzero_si256();
+  __m256i first, second;
+  unsigned i = 0;
+
+  for(; i + 32 <= n; i += 32){
+    first = ascii_to_pairs_avx2(_mm256_loadu_si256((const __m256i* )
+                                (src + 2*i)), &bad);
+    second = ascii_to_pairs_avx2(_mm256_loadu_si256((const __m256i* )
+                                 (src + 2*i + 32)), &bad);
+    _mm256_storeu_si256((__m256i* )(dst + i), _mm256_permute4x64_epi64(
+                        _mm256_packus_epi16(first, second), 0xD8));
+  }
+  if(_mm256_movemask_epi8(bad)){
+    return 0;
+  }
+  return decode_sse2(src + 2*i, n - i, dst + i);
+}
+#endif /* HEX_X86 */
+
+/*
+  Picks the widest kernels the processor supports. Runs before main() so the
+  workers formatting records never race on the selection.
+*/
+#ifdef HEX_X86
+__attribute__((constructor))
+static void select_kernels(void){
+  __builtin_cpu_init();
+  if(__builtin_cpu_supports("avx2")){
+    encode_kernel = encode_avx2;
+    sum_kernel = sum_avx2;
+    decode_kernel = decode_avx2;
+    kernel_name = "avx2";
+  }
+  else if(__builtin_cpu_supports("sse2")){
+    encode_kernel = encode_sse2;
+    sum_kernel = sum_sse2;
+    decode_kernel = decode_sse2;
+    kernel_name = "sse2";
+  }
+}
+#endif /* HEX_X86 */
+
+/*
+  Writes the 2*n uppercase hex characters of src into dst. No NUL is added.
+*/
+void hex_encode(const unsigned char* src, unsigned n, char* dst){
+  encode_kernel(src, n, dst);
+}
+
+/*
+  Turns the 2*n hex characters of src, upper or lower case, into n bytes in
+  dst. Returns 0 if any character is not a hex digit, in which case dst holds
+  partial results.
+*/
+int hex_decode(const char* src, unsigned n, unsigned char* dst){
+  return decode_kernel(src, n, dst);
+}
+
+/* Sum of n bytes, the caller keeps the bits its checksum needs */
+unsigned byte_sum(const unsigned char* src, unsigned n){
+  return sum_kernel(src, n);
+}
+
+const char* hex_kernel_name(void){
+  return kernel_name;
+}
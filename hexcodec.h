@@ -0,0 +1,19 @@
+#ifndef HEXCODEC_H
+#define HEXCODEC_H
+
+/*
+  hexcodec.h
+  Header file for hexcodec.c
+
+  Coder: Elias Vonapartis
+  Release Date: Oct 19, 2026
+  Latest Updates: Oct 19, 2026  - Added hex_decode()
+*/
+
+/* Function Declarations */
+void hex_encode(const unsigned char* , unsigned , char* );
+int hex_decode(const char* , unsigned , unsigned char* );
+unsigned byte_sum(const unsigned char* , unsigned );
+const char* hex_kernel_name(void);
+
+#endif /* HEXCODEC_H */
@@ -8,6 +8,17 @@
   Release Date: May 28, 2016
   Latest Updates: May 29, 2016  - Fixed the RETI Opcode
                   June 5, 2016  - Fixed the return value of tokenize_operands
+                  Oct 19, 2026  - Replaced the check functions with a table
+                                  driven operand classifier
+                                - Hashed lookup of case folded mnemonics
+                                - One entry per mnemonic, suffixes decoded
+                                - Pure classification split from the symbol
+                                  work for the parallel first pass
+                                - Operand symbols interned to IDs
+                                - Sizes from the addressing mode descriptors
+                                - Operand symbols bound through fixups
+                                - Records name their instruction by entry
+                                - Added the emulated mnemonics
 */
 
 #include <stdio.h>
@@ -21,152 +32,207 @@
 #include "records.h"
 #include "errors.h"
 
-#define LISTLENGTH 61
-
-struct inst_el inst_list[] = {
-  /* Mnemonic - Opcode - Operand - Size */
-  {"ADD", 0x5, DOUBLE, WORD},
-  {"ADD.B", 0x5, DOUBLE, BYTE},
-  {"ADD.W", 0x5, DOUBLE, WORD},
-
-  {"ADDC", 0x6, DOUBLE, WORD},
-  {"ADDC.B", 0x6, DOUBLE, BYTE},
-  {"ADDC.W", 0x6, DOUBLE, WORD},
-
-  {"AND", 0xF, DOUBLE, WORD},
-  {"AND.B", 0xF, DOUBLE, BYTE},
-  {"AND.W", 0xF, DOUBLE, WORD},
-
-  {"BIC", 0xC, DOUBLE, WORD},
-  {"BIC.B", 0xC, DOUBLE, BYTE},
-  {"BIC.W", 0xC, DOUBLE, WORD},
-
-  {"BIS", 0xD, DOUBLE, WORD},
-  {"BIS.B", 0xD, DOUBLE, BYTE},
-  {"BIS.W", 0xD, DOUBLE, WORD},
-
-  {"BIT", 0xB, DOUBLE, WORD},
-  {"BIT.B", 0xB, DOUBLE, BYTE},
-  {"BIT.W", 0xB, DOUBLE, WORD},
-
-  {"CALL", 0x25, SINGLE, WORD},
-
-  {"CMP", 0x9, DOUBLE, WORD},
-  {"CMP.B", 0x9, DOUBLE, BYTE},
-  {"CMP.W", 0x9, DOUBLE, WORD},
-
-  {"DADD", 0xA, DOUBLE, WORD},
-  {"DADD.B", 0xA, DOUBLE, BYTE},
-  {"DADD.W", 0xA, DOUBLE, WORD},
-
-  {"JC", 0xB, JUMP, OFFSET},
-  {"JEQ", 0x9, JUMP, OFFSET},
-  {"JGE", 0xD, JUMP, OFFSET},
-  {"JHS", 0xB, JUMP, OFFSET},
-  {"JL", 0xE, JUMP, OFFSET},
-  {"JLO", 0xA, JUMP, OFFSET},
-  {"JMP", 0xF, JUMP, OFFSET},
-  {"JN", 0xC, JUMP, OFFSET},
-  {"JNC", 0xA, JUMP, OFFSET},
-  {"JNE", 0x8, JUMP, OFFSET},
-  {"JNZ", 0x8, JUMP, OFFSET},
-  {"JZ", 0x9, JUMP, OFFSET},
-
-  {"MOV", 0x4, DOUBLE, WORD},
-  {"MOV.B", 0x4, DOUBLE, BYTE},
-  {"MOV.W", 0x4, DOUBLE, WORD},
-
-  {"PUSH", 0x24, SINGLE, WORD},
-  {"PUSH.B", 0x24, SINGLE, BYTE},
-  {"PUSH.W", 0x24, SINGLE, WORD},
-
-  {"RETI", 0x1300, NONE, WORD},
-
-  {"RRA", 0x22, SINGLE, WORD},
-  {"RRA.B", 0x22, SINGLE, BYTE},
-  {"RRA.W", 0x22, SINGLE, WORD},
-
-  {"RRC", 0x20, SINGLE, WORD},
-  {"RRC.B", 0x20, SINGLE, BYTE},
-  {"RRC.W", 0x20, SINGLE, WORD},
-
-  {"SUB", 0x8, DOUBLE, WORD},
-  {"SUB.B", 0x8, DOUBLE, BYTE},
-  {"SUB.W", 0x8, DOUBLE, WORD},
-
-  {"SUBC", 0x7, DOUBLE, WORD},
-  {"SUBC.B", 0x7, DOUBLE, BYTE},
-  {"SUBC.W", 0x7, DOUBLE, WORD},
-
-  {"SWPB", 0x21, SINGLE, WORD},
+/*
+  Base mnemonics only, the .B and .W suffixes are decoded separately and
+  checked against the widths each mnemonic accepts.
+*/
+struct inst_el inst_list[LISTLENGTH] = {
+  /* Mnemonic - Opcode - Operand - Suffixes */
+  {"ADD", 0x5, DOUBLE, SUFFIX_WB},
+  {"ADDC", 0x6, DOUBLE, SUFFIX_WB},
+  {"AND", 0xF, DOUBLE, SUFFIX_WB},
+  {"BIC", 0xC, DOUBLE, SUFFIX_WB},
+  {"BIS", 0xD, DOUBLE, SUFFIX_WB},
+  {"BIT", 0xB, DOUBLE, SUFFIX_WB},
+  {"CALL", 0x25, SINGLE, SUFFIX_W},
+  {"CMP", 0x9, DOUBLE, SUFFIX_WB},
+  {"DADD", 0xA, DOUBLE, SUFFIX_WB},
+
+  {"JC", 0xB, JUMP, SUFFIX_NONE},
+  {"JEQ", 0x9, JUMP, SUFFIX_NONE},
+  {"JGE", 0xD, JUMP, SUFFIX_NONE},
+  {"JHS", 0xB, JUMP, SUFFIX_NONE},
+  {"JL", 0xE, JUMP, SUFFIX_NONE},
+  {"JLO", 0xA, JUMP, SUFFIX_NONE},
+  {"JMP", 0xF, JUMP, SUFFIX_NONE},
+  {"JN", 0xC, JUMP, SUFFIX_NONE},
+  {"JNC", 0xA, JUMP, SUFFIX_NONE},
+  {"JNE", 0x8, JUMP, SUFFIX_NONE},
+  {"JNZ", 0x8, JUMP, SUFFIX_NONE},
+  {"JZ", 0x9, JUMP, SUFFIX_NONE},
+
+  {"MOV", 0x4, DOUBLE, SUFFIX_WB},
+  {"PUSH", 0x24, SINGLE, SUFFIX_WB},
+  {"RETI", 0x1300, NONE, SUFFIX_NONE},
+  {"RRA", 0x22, SINGLE, SUFFIX_WB},
+  {"RRC", 0x20, SINGLE, SUFFIX_WB},
+  {"SUB", 0x8, DOUBLE, SUFFIX_WB},
+  {"SUBC", 0x7, DOUBLE, SUFFIX_WB},
+  {"SWPB", 0x21, SINGLE, SUFFIX_W},
+  {"SXT", 0x23, SINGLE, SUFFIX_W},
+  {"XOR", 0xE, DOUBLE, SUFFIX_WB},
 
-  {"SXT", 0x23, SINGLE, WORD},
+  /*
+    Emulated mnemonics, assembled as the core instruction they stand for. The
+    opcode is their encoding with R5 as the operand, checked by the selftest.
+  */
+  /* Mnemonic - Encoding - Operand - Suffixes - Core, Source, Destination */
+  {"ADC", 0x6305, SINGLE, SUFFIX_WB, {"ADDC", "#0", NULL}},
+  {"BR", 0x4500, SINGLE, SUFFIX_W, {"MOV", NULL, "PC"}},
+  {"CLR", 0x4305, SINGLE, SUFFIX_WB, {"MOV", "#0", NULL}},
+  {"CLRC", 0xC312, NONE, SUFFIX_NONE, {"BIC", "#1", "SR"}},
+  {"CLRN", 0xC222, NONE, SUFFIX_NONE, {"BIC", "#4", "SR"}},
+  {"CLRZ", 0xC322, NONE, SUFFIX_NONE, {"BIC", "#2", "SR"}},
+  {"DADC", 0xA305, SINGLE, SUFFIX_WB, {"DADD", "#0", NULL}},
+  {"DEC", 0x8315, SINGLE, SUFFIX_WB, {"SUB", "#1", NULL}},
+  {"DECD", 0x8325, SINGLE, SUFFIX_WB, {"SUB", "#2", NULL}},
+  {"DINT", 0xC232, NONE, SUFFIX_NONE, {"BIC", "#8", "SR"}},
+  {"EINT", 0xD232, NONE, SUFFIX_NONE, {"BIS", "#8", "SR"}},
+  {"INC", 0x5315, SINGLE, SUFFIX_WB, {"ADD", "#1", NULL}},
+  {"INCD", 0x5325, SINGLE, SUFFIX_WB, {"ADD", "#2", NULL}},
+  {"INV", 0xE335, SINGLE, SUFFIX_WB, {"XOR", "#-1", NULL}},
+  {"NOP", 0x4303, NONE, SUFFIX_NONE, {"MOV", "#0", "R3"}},
+  {"POP", 0x4135, SINGLE, SUFFIX_WB, {"MOV", "@SP+", NULL}},
+  {"RET", 0x4130, NONE, SUFFIX_NONE, {"MOV", "@SP+", "PC"}},
+  {"RLA", 0x5505, SINGLE, SUFFIX_WB, {"ADD", NULL, NULL}},
+  {"RLC", 0x6505, SINGLE, SUFFIX_WB, {"ADDC", NULL, NULL}},
+  {"SBC", 0x7305, SINGLE, SUFFIX_WB, {"SUBC", "#0", NULL}},
+  {"SETC", 0xD312, NONE, SUFFIX_NONE, {"BIS", "#1", "SR"}},
+  {"SETN", 0xD222, NONE, SUFFIX_NONE, {"BIS", "#4", "SR"}},
+  {"SETZ", 0xD322, NONE, SUFFIX_NONE, {"BIS", "#2", "SR"}},
+  {"TST", 0x9305, SINGLE, SUFFIX_WB, {"CMP", "#0", NULL}}
+};
 
-  {"XOR", 0xE, DOUBLE, WORD},
-  {"XOR.B", 0xE, DOUBLE, BYTE},
-  {"XOR.W", 0xE, DOUBLE, WORD}
+/*
+  Addressing mode descriptors shared by both passes, indexed by mode_row().
+  Only register, indexed, relative and absolute are valid destinations.
+*/
+static const struct mode_desc mode_descs[MODE_ROWS] = {
+  /* As - Ad - Register - Extension words - PC bias - Destination */
+  {0, 0, NO_REG, 0, 0, TRUE},             /* REGISTER */
+  {1, 1, NO_REG, 1, 0, TRUE},             /* INDEXED */
+  {1, 1, PC_REG, 1, 4, TRUE},             /* RELATIVE */
+  {1, 1, SR_REG, 1, 0, TRUE},             /* ABSOLUTE */
+  {2, 0, NO_REG, 0, 0, FALSE},            /* INDIRECT */
+  {3, 0, NO_REG, 0, 0, FALSE},            /* INDIRECT_INCR */
+  {3, 0, PC_REG, 1, 0, FALSE},            /* IMMEDIATE */
+  {0, 0, NO_REG, 0, 0, FALSE},            /* BAD_ADDR_MODE */
+  {3, 0, CG_REG, 0, 0, FALSE},            /* #-1 */
+  {0, 0, CG_REG, 0, 0, FALSE},            /* #0 */
+  {1, 0, CG_REG, 0, 0, FALSE},            /* #1 */
+  {2, 0, CG_REG, 0, 0, FALSE},            /* #2 */
+  {2, 0, SR_REG, 0, 0, FALSE},            /* #4 */
+  {3, 0, SR_REG, 0, 0, FALSE}             /* #8 */
 };
 
+/* Constant generator rows by value plus one, for the CONGEN() values */
+static const unsigned char cg_rows[] = {CG_MINUS_ONE, CG_ZERO, CG_ONE, CG_TWO,
+                                  BAD_ADDR_MODE, CG_FOUR, BAD_ADDR_MODE,
+                                  BAD_ADDR_MODE, BAD_ADDR_MODE, CG_EIGHT};
+
 /*
-  Binary search for instruction list. By adjusting the global LISTLENGTH it
-  self-adjusts to find the new middle, whether it's an odd or even length.
-  Follows the basic binary search principles.
+  Perfect hash index over inst_list, holding the list index plus one so that 0
+  marks an empty slot. init_inst_index() searches for a seed under which no
+  two base mnemonics share a slot, so a lookup is a single probe.
 */
+static unsigned char inst_index[INST_SLOTS];
+static unsigned inst_seed;
+
+#define INST_SLOT(hash, seed) \
+        ((((hash) ^ (seed)) * 0x9E3779B1u) >> (32 - INST_SLOT_BITS))
+
+void init_inst_index(void){
+  unsigned slot;
+  unsigned i;
+
+  for(inst_seed = 0; ; inst_seed++){
+    memset(inst_index, 0, sizeof(inst_index));
+    for(i = 0; i < LISTLENGTH; i++){
+      slot = INST_SLOT(hash_key(inst_list[i].inst), inst_seed);
+      if(inst_index[slot]){
+        break;                  // Collision, try the next seed
+      }
+      inst_index[slot] = i + 1;
+    }
+    if(i == LISTLENGTH){
+      return;
+    }
+  }
+}
 
-struct inst_el* get_inst(char* inst){
-  int middle;
-  int old_middle;
-  int length;
-  int search;
+/*
+  Finds the base mnemonic of a token key. The probe is a memcmp() of two keys,
+  the case having been folded and the suffix split off when the key was made.
+*/
+struct inst_el* get_inst_key(const struct token_key* key){
+  unsigned char index;
 
-  if((LISTLENGTH)%2){
-    middle = (float)LISTLENGTH/2 + 0.5;
+  if(!key->length){
+    return NULL;
   }
-  else{
-    middle = LISTLENGTH/2;
+  index = inst_index[INST_SLOT(key->hash, inst_seed)];
+  if(index && memcmp(inst_list[index - 1].inst, key->name, KEY_LEN) == 0){
+    return &inst_list[index - 1];
   }
+  return NULL;
+}
 
-  length = middle;
-  search = strcasecmp(inst, inst_list[middle].inst);
-
-  while(search){
-    if(length == 0){
+/*
+  Works out the operation size of an instruction from the suffix of its key.
+  Returns NULL, or the error message if the suffix is not one the mnemonic
+  accepts. bw is set either way so the LC stays in step.
+*/
+const char* check_suffix(struct inst_el* instptr, const struct token_key* key,
+                         enum BYTE_COMB* bw){
+  *bw = instptr->type == JUMP ? OFFSET : WORD;
+
+  switch (key->suffix) {
+    case NUL:
+    return NULL;
+    case 'W':
+    if(instptr->widths & SUFFIX_W){
       return NULL;
     }
+    break;
+    case 'B':
+    if(instptr->widths & SUFFIX_B){
+      *bw = BYTE;
+      return NULL;
+    }
+    return "ERROR: Instruction has no byte form:";
+    default:
+    return "ERROR: Invalid size suffix, expected .B or .W:";
+  }
+  return "ERROR: Instruction does not take a size suffix:";
+}
 
-    old_middle = middle;
+/* check_suffix() reporting the error against token. Returns FALSE on error */
+unsigned char decode_suffix(struct inst_el* instptr,
+                            const struct token_key* key, char* token,
+                            enum BYTE_COMB* bw){
+  const char* error = check_suffix(instptr, key, bw);
 
-    if(search < 0){
-      middle = middle - (float)(length)/2 - 0.5;
-      length = old_middle - middle - 1;
-    }
-    else{
-      middle = middle + (float)(length)/2 + 0.5;
-      length = middle - old_middle - 1;
-    }
-    search = strcasecmp(inst, inst_list[middle].inst);
+  if(error){
+    error_count((char*)error, token);
+    return FALSE;
   }
-  return &inst_list[middle];
+  return TRUE;
 }
-/*
- //Commenting this out for backup
+
 struct inst_el* get_inst(char* inst){
-  struct inst_el *ptr; // Pointer to the list
-  ptr = &inst_list[0]; // Initiate at top of inst_list
+  struct token_key key;
 
-  // Compare argument to entries in table
-  while(strcasecmp(ptr -> inst, LASTINST) != 0){
-    if(strcasecmp(ptr -> inst, inst) == 0){
-      return ptr;
-    }
-    else{
-      ptr++;
-    }
-  }
-  return NULL;
+  make_key(inst, &key);
+  return get_inst_key(&key);
 }
+
+/*
+  Handles the instruction of a record. info is the line as classified by
+  classify_line() in the parallel step of the first pass, or NULL if the
+  operands still have to be split and classified here.
 */
-void analyzeinstruction(char* line, struct firsttoken srctoken){
+void analyzeinstruction(char* line, struct firsttoken srctoken,
+                        struct line_info* info){
   #ifdef debug
   printf("INST TOKEN >>%s<<\n", srctoken.instptr->inst);
   printf("INST LINE >>%s<<\n", line);
@@ -175,12 +241,7 @@ void analyzeinstruction(char* line, struct firsttoken srctoken){
   /* If the first token was a label add it to the symbol table with the LC */
 
   if(flag_first_token_label){
-    if(!get_entry(global)){
-      add_entry(global, LC, LBLTYPE);
-    }
-    else{
-      update_entry(global , LC, LBLTYPE);
-    }
+    define_label(global, LC, record_count());
   }
 
   /*
@@ -195,46 +256,50 @@ void analyzeinstruction(char* line, struct firsttoken srctoken){
     #ifdef debug
     printf("INST CASE: NONE\n");
     #endif /* debug */
-    if(checkjunkrecord(line)){
+    if(!checkjunkrecord(line)){
+      break;
+    }
+    if(srctoken.instptr->emul.core){
+      commit_emulated(srctoken, NULL, NULL);
+    }
+    else{
+      add_inst_record(srctoken.instptr, srctoken.bw, NULL, NULL);
       LC += WORD_INC;                 //Increment the LC by 2
-      add_inst_record(srctoken.instptr->inst, srctoken.instptr->type, NULL,
-                      NULL, -1, -1);
     }
     break;
     case JUMP:
     #ifdef debug
     printf("INST CASE: JUMP\n");
     #endif /* debug */
-    checkjump(line, srctoken.instptr->inst); //checks the validity of the record
+    checkjump(line, srctoken.instptr); //checks the validity of the record
     break;
     case SINGLE:
     #ifdef debug
     printf("INST CASE: SINGLE\n");
     #endif /* debug */
-    operand_parser(line, SINGLE, srctoken.instptr->inst);
-    break;
     case DOUBLE:
-    #ifdef debug
-    printf("INST CASE: DOUBLE\n");
-    #endif /* debug */
-    operand_parser(line, DOUBLE, srctoken.instptr->inst);
+    if(info){
+      commit_operands(srctoken, srctoken.instptr->type, info->src_text,
+                      info->dst_text, &info->src, &info->dst);
+    }
+    else{
+      operand_parser(line, srctoken.instptr->type, srctoken);
+    }
     break;
   }
 }
 /*
   The operand parser takes the untokenized operands of single and double operand
-  instructions, calls on a tokenizer specifically coded for operands and then
-  based on the first char of the operand checks for the validity of the potential
-  addressing mode.
+  instructions, splits them with tokenize_operands() and classifies each one.
+  The symbol lookups are done by commit_operands(), after classification, so
+  classify_operand() itself never touches the symbol table or the error count.
 */
-void operand_parser(char* operand, enum INST_TYPE type, char* inst){
-  enum ADDR_MODE src_addr_mode;
-  enum ADDR_MODE dst_addr_mode;
-
-  char* source = malloc(sizeof(short));
-  char* destination = malloc(sizeof(short));
-
-  flag_const_immediate = FALSE; //ensure it is false prior to parsing operands
+void operand_parser(char* operand, enum INST_TYPE type,
+                    struct firsttoken srctoken){
+  struct operand src;
+  struct operand dst;
+  char* source;
+  char* destination;
 
   // Returns the tokenized source and/or destination
   if(!tokenize_operands(operand, type, &source, &destination)){
@@ -242,392 +307,452 @@ void operand_parser(char* operand, enum INST_TYPE type, char* inst){
     return;
   }
 
-  // Check the source operand
-  switch (*source) {
-    case '&':
-    #ifdef debug
-    printf("CHECKING SOURCE >>%s<< ABSOLUTE\n", source);
-    #endif /* debug */
-    checkabsolute(source, &src_addr_mode);
-    break;
-    case '@':
-    #ifdef debug
-    printf("CHECKING SOURCE >>%s<< INDIRECT or INDIRECT AUTO\n", source);
-    #endif /* debug */
-    checkindirect(source, &src_addr_mode);
-    break;
-    case '#':
-    #ifdef debug
-    printf("CHECKING SOURCE >>%s<< IMMEDIATE\n", source);
-    #endif /* debug */
-    checkimmediate(source, &src_addr_mode);
-    break;
-    default:
-    #ifdef debug
-    printf("CHECKING SOURCE >>%s<< for RegDir, Indexed, Symbolic\n", source);
-    #endif /* debug */
-    checkdefault(source, &src_addr_mode);
-    break;
+  classify_operand(source, &src);
+  if(type == DOUBLE){
+    classify_operand(destination, &dst);
+  }
+  commit_operands(srctoken, type, source, destination, &src, &dst);
+}
+
+/*
+  Gives the operands of the core instruction an emulation stands for. The fixed
+  ones are classified from the emulation, the others are a copy of op, the
+  operand written, with text as their text.
+*/
+void emulated_operands(const struct emulation* emul, char* text,
+                       const struct operand* op, char** src_text,
+                       struct operand* src, char** dst_text,
+                       struct operand* dst){
+  *src_text = emul->src ? (char* )emul->src : text;
+  *dst_text = emul->dst ? (char* )emul->dst : text;
+  if(emul->src){
+    classify_operand(emul->src, src);
+  }
+  else{
+    *src = *op;
+  }
+  if(emul->dst){
+    classify_operand(emul->dst, dst);
+  }
+  else{
+    *dst = *op;
+  }
+}
+
+/*
+  Commits an emulated instruction as its core instruction, so the record, the
+  encoding and the size are those of the core instruction with a constant
+  generator source where there is one. op is the classified operand written,
+  or NULL if the mnemonic takes none. An error in it is reported once, though
+  RLA and RLC use it twice.
+*/
+void commit_emulated(struct firsttoken srctoken, char* text,
+                     struct operand* op){
+  const struct emulation* emul = &srctoken.instptr->emul;
+  struct operand src;
+  struct operand dst;
+  char* src_text;
+  char* dst_text;
+
+  if(op && op->error != OPE_NONE){
+    resolve_operand(text, op);
+    fprintf(fout, "Cannot Process this Instruction due to Errors.\n");
+    return;
+  }
+  emulated_operands(emul, text, op, &src_text, &src, &dst_text, &dst);
+  srctoken.instptr = get_inst((char* )emul->core);
+  commit_operands(srctoken, DOUBLE, src_text, dst_text, &src, &dst);
+}
+
+/*
+  Resolves the symbols of classified operands, checks the destination mode and
+  records the instruction, advancing the LC by its size. The size is taken from
+  the descriptors once the symbols are resolved, as an immediate symbol may
+  turn out to be a constant generator value. The record's operands are then
+  bound to their symbols, a rejected instruction still counting as a use.
+*/
+void commit_operands(struct firsttoken srctoken, enum INST_TYPE type,
+                     char* source, char* destination, struct operand* src,
+                     struct operand* dst){
+  unsigned record = NO_RECORD;
+  unsigned char valid;
+
+  if(srctoken.instptr->emul.core){
+    commit_emulated(srctoken, source, src);
+    return;
   }
+  valid = resolve_operand(source, src);
 
   // If the inst was a doubleop check the accepted destination addr modes
   if(type == DOUBLE){
-    switch (*destination) {
-      case '&':
-      #ifdef debug
-      printf("CHECKING DESTINATION >>%s<< ABSOLUTE\n", destination);
-      #endif /* debug */
-      checkabsolute(destination, &dst_addr_mode);
-      break;
-      case '@':
-      case '#':
-      error_count("ERROR: Invalid destination addressing mode.", NULL);
-      break;
-      default:
-      #ifdef debug
-      printf("CHECKING DESTINATION >>%s<< DEFAULT\n", destination);
-      #endif /* debug */
-      checkdefault(destination, &dst_addr_mode);
-      break;
+    if(resolve_operand(destination, dst)){
+      if(!operand_desc(dst)->dst_ok){
+        error_count("ERROR: Invalid destination addressing mode.", NULL);
+        valid = FALSE;
+      }
+    }
+    else{
+      valid = FALSE;
     }
   }
 
-  if(src_addr_mode == BAD_ADDR_MODE || dst_addr_mode == BAD_ADDR_MODE){
+  if(!valid){
     fprintf(fout, "Cannot Process this Instruction due to Errors.\n");
-    return;
   }
-  /* Adds necessary information to a linked list for the second pass codegen */
-  add_inst_record(inst, type, source, destination, src_addr_mode, dst_addr_mode);
-  /* Based on SRC and DST we increment the LC accordingly */
-  incrementLC(&src_addr_mode, &dst_addr_mode);
+  else{
+    /* Adds necessary information to a linked list for the second pass */
+    record = add_inst_record(srctoken.instptr, srctoken.bw, src,
+                             type == DOUBLE ? dst : NULL);
+    incrementLC(instruction_size(src, type == DOUBLE ? dst : NULL));
+  }
+
+  if(src->symbol != NO_SYMBOL){
+    add_fixup(src->symbol, record, FIX_SRC);
+  }
+  if(type == DOUBLE && dst->symbol != NO_SYMBOL){
+    add_fixup(dst->symbol, record, FIX_DST);
+  }
 }
 
-unsigned char tokenize_operands(char* operand,enum INST_TYPE type,char** source,
-                       char** destination){
-  char* token;
-  char* src = malloc(sizeof(short));
-  char* dst = malloc(sizeof(short));
-  char* temp;
-  unsigned short i;
-  unsigned char res = FALSE;
+/*
+  Splits the operand field into the source and, for double operand
+  instructions, the destination. Spaces are allowed around the comma but not
+  inside an operand. The operands are NUL terminated in place. Returns NULL, or
+  the error message if the field is malformed.
+*/
+const char* split_operands(char* operand, enum INST_TYPE type, char** source,
+                           char** destination){
+  char* end;
 
   *source = NULL;
   *destination = NULL;
 
-  while(*operand == ' '){             // Go to first legible character
-    *operand++;
-  }
-  token = strtok(operand, "\t\r\n");  // Do not search for whitespace since
-                                      // double ops may have a space after comma
-                                      // this leaves space after the end of the
-                                      // double op, which is dealt with later
-
-  if(token == NULL){
-    error_count("ERROR: Missing Operand(s) for Instruction.", NULL);
-    return res;
+  operand += strspn(operand, " \t\r\n");  // Go to first legible character
+  if(*operand == NUL){
+    return "ERROR: Missing Operand(s) for Instruction.";
   }
 
   if(type == DOUBLE){
-    for(i = 0; token[i] != ','; i++){ // Search for comma, characteristic of dbl
-      if (i == MAX_NAME_LEN){         // Label can't be larger than 32
-        error_count("ERROR: Operand too long or no ',' for DoubleOp.", NULL);
-        return res;                 // To avoid overflow and infinite looping
-      }
-      src[i] = token[i];              // Copies the chars up to the comma
-    }                                 // thus comprising the source operand
-
-    dst = strtok(token + i + 1, " \t\r\n");
-    if(dst == NULL){
-      error_count("ERROR: Missing Second Operand for Double Instruction.", NULL);
-      return res;
+    end = strchr(operand, ',');           // Characteristic of a double op
+    if(end == NULL){
+      return "ERROR: Missing ',' between the operands of a DoubleOp.";
     }
+    *end++ = NUL;
+    *source = operand;
+    operand[strcspn(operand, " \t\r\n")] = NUL;
 
-    temp = strtok(src, " \t\r\n"); //To remove any potential spaces for extra \t
-
-    #ifdef debug
-    printf("double_op_s: >>%s<<\n", temp);
-    printf("double_op_d: >>%s<<\n", dst);
-    #endif /* debug */
-    *source = temp;
-    *destination = dst;
+    operand = end + strspn(end, " \t\r\n");
+    if(**source == NUL || *operand == NUL){
+      return "ERROR: Missing Operand for Double Instruction.";
+    }
+    *destination = operand;
+    operand += strcspn(operand, " \t\r\n");
   }
   else{
-    *source = strtok(token, " ");     // Remove Spaces left by the 1st tokenize
-    #ifdef debug
-    printf("single_op_s: >>%s<<\n", *source);
-    #endif
+    *source = operand;
+    operand += strcspn(operand, " \t\r\n");
+  }
+
+  // Whatever follows the last operand must be whitespace
+  if(*operand != NUL){
+    *operand++ = NUL;
+    if(operand[strspn(operand, " \t\r\n")] != NUL){
+      return "ERROR: Line contains unecessary text.";
+    }
   }
-  res = TRUE;
-  return res;
+  return NULL;
 }
 
-void checkabsolute(char* operand, enum ADDR_MODE* mode){
-  *operand++; //increment pointer past &
+/* split_operands() reporting any error. Returns FALSE on error */
+unsigned char tokenize_operands(char* operand,enum INST_TYPE type,char** source,
+                       char** destination){
+  const char* error = split_operands(operand, type, source, destination);
 
+  if(error){
+    error_count((char*)error, NULL);
+    return FALSE;
+  }
   #ifdef debug
-  printf("TESTING >>%s<<\n", operand);
+  printf("operand_s: >>%s<<\n", *source);
+  if(*destination){
+    printf("operand_d: >>%s<<\n", *destination);
+  }
   #endif /* debug */
+  return TRUE;
+}
 
-  if(is_label(operand)){        // First check if op can be label
-    if(get_entry(operand)){
-      #ifdef debug
-      printf("OPERAND >>%s<< ABS EXISTING LABEL\n", operand);
-      #endif
-    }
-    else{
-      add_entry(operand, 0, UNKTYPE);
-      #ifdef debug
-      printf("OPERAND >>%s<< ABS UNKNOWN LABEL\n", operand);
-      #endif
-    }
-    *mode = ABSOLUTE;
-  }
-  else if(is_number(operand) < MAX_BIT_VAL){  //If not label check numeric
-    #ifdef debug
-    printf("OPERAND >>%s<< ABS NUMERIC\n", operand);
-    #endif
-    *mode = ABSOLUTE;
-  }
-  else{
-    #ifdef debug
-    printf("OPERAND >>%s<< INVALID ABSOLUTE\n", operand);
-    #endif
-    error_count("ERROR: Invalid Absolute Operand:", operand);
-    *mode = BAD_ADDR_MODE;
+/* Character classes of 7-bit ASCII, anything above is CC_OTHER */
+#define X CC_OTHER
+#define A CC_ALPHA
+#define D CC_DIGIT
+static const unsigned char char_class[128] = {
+  CC_END, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,         /* 0x00 */
+  X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,              /* 0x10 */
+  X, X, X, CC_HASH, CC_NUMBER, X, CC_AMP, X,                   /* 0x20 */
+  CC_OPEN, CC_CLOSE, X, CC_PLUS, X, CC_NUMBER, X, X,
+  D, D, D, D, D, D, D, D, D, D, X, X, X, X, X, X,              /* 0x30 */
+  CC_AT, A, A, A, A, A, A, A, A, A, A, A, A, A, A, A,          /* 0x40 */
+  A, A, A, A, A, A, A, A, A, A, A, X, X, X, X, X,              /* 0x50 */
+  X, A, A, A, A, A, A, A, A, A, A, A, A, A, A, A,              /* 0x60 */
+  A, A, A, A, A, A, A, A, A, A, A, X, X, X, X, X               /* 0x70 */
+};
+#undef X
+#undef A
+#undef D
+
+/*
+  States of the operand classifier. OS_LITERAL is never stored, it tells the
+  loop to read a number with parse_number() and carry on in OS_VALUE.
+*/
+enum OP_STATE {OS_START, OS_PREFIX, OS_AT, OS_NAME, OS_VALUE, OS_AT_NAME,
+               OS_INCR, OS_OPEN, OS_INDEX, OS_CLOSE, OS_DONE, OS_ERROR,
+               OS_LITERAL};
+
+#define E OS_ERROR
+static const unsigned char op_transitions[OS_DONE][CC_LAST] = {
+  /*            OTHER ALPHA       DIGIT       HASH       AMP        AT     PLUS
+                OPEN     CLOSE     NUMBER      END */
+  /* START  */ {E, OS_NAME,    OS_LITERAL, OS_PREFIX, OS_PREFIX, OS_AT, E,
+                E,       E,        OS_LITERAL, E},
+  /* PREFIX */ {E, OS_NAME,    OS_LITERAL, E,         E,         E,     E,
+                E,       E,        OS_LITERAL, E},
+  /* AT     */ {E, OS_AT_NAME, E,          E,         E,         E,     E,
+                E,       E,        E,          E},
+  /* NAME   */ {E, OS_NAME,    OS_NAME,    E,         E,         E,     E,
+                OS_OPEN, E,        E,          OS_DONE},
+  /* VALUE  */ {E, E,          E,          E,         E,         E,     E,
+                OS_OPEN, E,        E,          OS_DONE},
+  /* AT_NAME*/ {E, OS_AT_NAME, OS_AT_NAME, E,         E,         E,  OS_INCR,
+                E,       E,        E,          OS_DONE},
+  /* INCR   */ {E, E,          E,          E,         E,         E,     E,
+                E,       E,        E,          OS_DONE},
+  /* OPEN   */ {E, OS_INDEX,   E,          E,         E,         E,     E,
+                E,       E,        E,          E},
+  /* INDEX  */ {E, OS_INDEX,   OS_INDEX,   E,         E,         E,     E,
+                E,       OS_CLOSE, E,          E},
+  /* CLOSE  */ {E, E,          E,          E,         E,         E,     E,
+                E,       E,        E,          OS_DONE}
+};
+#undef E
+
+/* Error reported when a state meets a character it has no transition for */
+static const unsigned char op_state_errors[OS_DONE] = {
+  OPE_SYNTAX, OPE_SYNTAX, OPE_NOT_REG, OPE_SYNTAX, OPE_SYNTAX, OPE_SYNTAX,
+  OPE_SYNTAX, OPE_NOT_INDEX, OPE_PAREN, OPE_SYNTAX
+};
+
+/*
+  Classifies a single operand in one pass over its characters. Fills in the
+  addressing mode, the register, the literal value or symbol span and whether
+  an immediate literal comes from the constant generator. It has no side
+  effects, symbols are looked up by the caller.
+*/
+void classify_operand(const char* text, struct operand* op){
+  enum OP_STATE state = OS_START;
+  enum OP_STATE next;
+  enum NUM_STATUS status;
+  unsigned char cls;
+  unsigned char prefix = NUL;     // '#', '&' or '@'
+  unsigned char flag_literal = FALSE;
+  unsigned char flag_autoinc = FALSE;
+  unsigned short pos = 0;
+  unsigned short name_start = 0;
+  unsigned short name_len = 0;
+  unsigned short index_start = 0;
+  unsigned short index_len = 0;
+  unsigned length;
+
+  op->mode = BAD_ADDR_MODE;
+  op->reg = NO_REG;
+  op->value = 0;
+  op->sym_start = 0;
+  op->sym_len = 0;
+  op->symbol = NO_SYMBOL;
+  op->constgen = FALSE;
+  op->error = OPE_NONE;
+
+  if(text == NULL || *text == NUL){
+    op->error = OPE_MISSING;
+    return;
   }
-}
 
-void checkindirect(char* operand, enum ADDR_MODE* mode){
-  struct symbol_entry* symbl;
-  unsigned short i;
-  unsigned char indirect_flag = 0;
-  unsigned char autoinc_flag = 0;
+  while(state != OS_DONE){
+    cls = (unsigned char)text[pos] < 128 ? char_class[(unsigned char)text[pos]]
+                                         : CC_OTHER;
+    next = op_transitions[state][cls];
 
-  *operand++;
-  #ifdef debug
-  printf("TESTING >>%s<<\n", operand);
-  #endif
-
-  for(i = 0; operand[i] != '+'; i++){
-    if (i == REG_SIZE){ // Max length of a register 3, (e.g. R15+)
-      #ifdef debug
-      printf("OPERAND TOO LONG IF EXPECTING AUTOINC\n");
-      #endif /* debug */
-      break;       // To avoid overflow and infinite looping
+    if(next == OS_LITERAL){
+      status = parse_number(text + pos, &op->value, &length);
+      if(status != NUM_OK){
+        op->error = status == NUM_RANGE ? OPE_RANGE : OPE_LITERAL;
+        return;
+      }
+      flag_literal = TRUE;
+      pos += length;
+      state = OS_VALUE;
+      continue;
     }
-  }
-  /*
-  If there is a plus sign it checks to see if there is anything else
-  following the sign, to ensure proper format
-  */
-  if(operand[i] == '+' && ((operand[i+1]) == NUL)){
-    operand[i] = NUL;   // Now we null the +
-    // might need to break this up for accurate error message
-    #ifdef debug
-    printf("POTENTIALLY AUTOINC\n");
-    #endif
-    autoinc_flag = TRUE;
-  }
-
-  if(symbl = get_entry(operand)){
-    if(symbl->type == REGTYPE){
-      #ifdef debug
-      printf("OPERAND >>%s<< INDIRECT\n", operand);
-      #endif
-      indirect_flag = TRUE;
-      *mode = INDIRECT;
+    if(next == OS_ERROR || (next == OS_OPEN && prefix != NUL)){
+      op->error = op_state_errors[state];
+      return;
     }
-    else{
-      error_count("ERROR: Operand must be a Register in Register Indirect"
-                  " Addressing:", operand);
-      *mode = BAD_ADDR_MODE;
+
+    if(next != state){
+      switch(next){
+        case OS_PREFIX:
+        case OS_AT:
+        prefix = text[pos];
+        break;
+        case OS_NAME:
+        case OS_AT_NAME:
+        name_start = pos;
+        break;
+        case OS_INDEX:
+        index_start = pos;
+        break;
+        case OS_INCR:
+        flag_autoinc = TRUE;
+        break;
+        default:
+        break;
+      }
+      switch(state){
+        case OS_NAME:
+        case OS_AT_NAME:
+        name_len = pos - name_start;
+        break;
+        case OS_INDEX:
+        index_len = pos - index_start;
+        break;
+        default:
+        break;
+      }
     }
-  }
-  else{
-    error_count("ERROR: Operand Must be a register in Register Indirect"
-                " Addressing:", operand);
-    *mode = BAD_ADDR_MODE;
+    state = next;
+    pos++;
   }
 
-  if(autoinc_flag && indirect_flag){
-    #ifdef debug
-    printf(">>%s<<+ is Indirect Autoincrement\n", operand);
-    #endif
-    *mode = INDIRECT_INCR;
+  if(name_len >= MAX_NAME_LEN){
+    op->error = OPE_LONG;
+    return;
+  }
+  if(flag_literal && (op->value < -32768 || op->value > MAX_BIT_VAL)){
+    op->error = OPE_RANGE;
+    return;
   }
-}
 
-void checkimmediate(char* operand, enum ADDR_MODE* mode){
-  struct symbol_entry* symbl;
-  int temp;
+  if(prefix == '@'){
+    if((op->reg = register_number(text + name_start, name_len)) == NO_REG){
+      op->error = OPE_NOT_REG;
+      return;
+    }
+    op->mode = flag_autoinc ? INDIRECT_INCR : INDIRECT;
+    return;
+  }
 
-  flag_const_immediate = FALSE;
-  *operand++;
-  #ifdef debug
-  printf("TESTING >>%s<<\n", operand);
-  #endif
-
-  if(is_label(operand)){
-    if(symbl = get_entry(operand)){
-      if(symbl->type != REGTYPE){
-        #ifdef debug
-        printf("OPERAND >>%s<< IMMEDIATE EXISTING LABEL\n", operand);
-        #endif
-        *mode = IMMEDIATE;
-        if(CONGEN(symbl->value)){
-          flag_const_immediate = TRUE;
-        }
-      }
-      else{
-        error_count("ERROR: Operand cannot be a Register in Immediate"
-                    " Addressing:", operand);
-        *mode = BAD_ADDR_MODE;
-      }
+  if(index_len){
+    if((op->reg = register_number(text + index_start, index_len)) == NO_REG){
+      op->error = OPE_NOT_INDEX;
+      return;
     }
-    else{
-      add_entry(operand, 0, UNKTYPE);
-      #ifdef debug
-      printf("OPERAND >>%s<< IMMEDIATE UNKNOWN LABEL\n", operand);
-      #endif
-      *mode = IMMEDIATE;
+    if(!flag_literal && register_number(text + name_start, name_len) != NO_REG){
+      op->error = OPE_BASE_REG;
+      return;
     }
+    op->mode = INDEXED;
   }
-  else if((temp = is_number(operand)) != EXIT_FAIL){
-    #ifdef debug
-    printf("OPERAND >>%s<< IMMEDIATE NUMERICAL\n", operand);
-    #endif
-    *mode = IMMEDIATE;
-    if(CONGEN(temp)){ // I need to show that this is a special case
-      #ifdef debug
-      printf("IMMEDIATE CONSTANT GENERATOR NUMBER\n");
-      #endif
-      *mode = IMMEDIATE;
-      flag_const_immediate = TRUE;
+  else if(!flag_literal && register_number(text+name_start, name_len) != NO_REG){
+    if(prefix != NUL){
+      op->error = OPE_REG_VALUE;
+      return;
     }
+    op->reg = register_number(text + name_start, name_len);
+    op->mode = REGISTER;
+    return;
   }
   else{
-    error_count("ERROR: Operand Invalid Immediate:", operand);
-    *mode = BAD_ADDR_MODE;
+    op->mode = prefix == '#' ? IMMEDIATE : prefix == '&' ? ABSOLUTE : RELATIVE;
+  }
+
+  if(flag_literal){
+    op->constgen = op->mode == IMMEDIATE && CONGEN(op->value);
+  }
+  else{
+    op->sym_start = name_start;
+    op->sym_len = name_len;
   }
 }
 
-// Checks for indexed, relative or register direct
-void checkdefault(char* operand, enum ADDR_MODE* mode){
+/* Messages for the OPERAND_ERROR codes, the operand text is appended */
+static const char* operand_errors[] = {
+  NULL,
+  "ERROR: Missing Operand(s) for Instruction.",
+  "ERROR: Operand Unindentifiable:",
+  "ERROR: Invalid number in Operand:",
+  "ERROR: Number out of range in Operand:",
+  "ERROR: Operand must be a Register in Register Indirect Addressing:",
+  "ERROR: Operand cannot be a Register in Immediate or Absolute Addressing:",
+  "ERROR: Index Operand is not a Register:",
+  "ERROR: The base address cannot be a register:",
+  "ERROR: There may be a missing closing parenthesis:",
+  "ERROR: Label is too long:"
+};
+
+/*
+  Reports classification errors and looks up the symbol of a classified
+  operand, adding forward references to the symbol table. The operand keeps
+  the ID of the symbol, not its name. An immediate symbol that is already
+  defined with a constant generator value is flagged so both passes size it
+  the same way. Returns FALSE if the operand is unusable.
+*/
+unsigned char resolve_operand(char* text, struct operand* op){
   struct symbol_entry* symbl;
-  char* baseaddress;
-  char* index;
-  char* ptr;
-  unsigned char flag_valid_base = FALSE;
-  unsigned char flag_valid_index = FALSE;
-  unsigned short i = 0;
-
-  baseaddress = (char* )malloc(sizeof(char)*strlen(operand));
-  index = (char* )malloc((sizeof(char))*REG_SIZE);
-
-  if(is_label(operand)){
-    if(symbl = get_entry(operand)){
-      if(symbl->type != REGTYPE){
-        printf("OPERAND >>%s<< EXISTING LABEL RELATIVE\n", operand);
-        *mode = RELATIVE;
-      }
-      else{
-        printf("OPERAND >>%s<< REGISTER DIRECT\n", operand);
-        *mode = REGISTER;
-      }
-    }
-    else{
-      printf("OPERAND >>%s<< UNKNOWN LABEL RELATIVE\n", operand);
-      add_entry(operand, 0, UNKTYPE);
-      *mode = RELATIVE;
-    }
-  }
+  unsigned char inserted;
+  char* name;
 
-  else if(ptr = strstr(operand, "(")){
-    *ptr++;
+  if(op->error != OPE_NONE){
+    error_count((char*)operand_errors[op->error], text);
+    op->mode = BAD_ADDR_MODE;
+    return FALSE;
+  }
 
-    for(i = 0; ptr[i] != ')' && i <= REG_SIZE; i++){
-      index[i] = ptr[i];
-    }
-    if(i == (REG_SIZE + 1)){ //The for loop increases i once unecessarily
-      error_count("ERROR: There may be a missing closing parenthesis.", NULL);
-      *mode = BAD_ADDR_MODE;
-    }
-    else{
-      symbl = get_entry(index);
-      if(symbl->type != REGTYPE){
-        error_count("ERROR: Index Operand is not a Register:", index);
-        *mode = BAD_ADDR_MODE;
-      }
-      else if(symbl->name == "RO" || symbl->name == "PC"){
-        fprintf(fout, "WARNING: By using an index with the PC you are making use"
-                " of relative addressing\n");
-                flag_valid_index = TRUE;
-      }
-      else{
-        flag_valid_index = TRUE;
-        #ifdef debug
-        printf("Operand >>%s<< valid index.\n", index);
-        #endif /* debug */
-      }
-    }
+  if(op->mode == INDEXED && op->reg == 0){     // R0 is the PC
+    fprintf(fout, "WARNING: By using an index with the PC you are making use"
+            " of relative addressing\n");
+  }
 
-    /* Now to find the base address */
-    i = 0; // Reset the counter
+  if(op->sym_len == 0){
+    return TRUE;
+  }
 
-    while(operand[i] != '('){     // Search for the opening parenthesis
-      baseaddress[i] = operand[i];// No need to break at MAX_NAME_LEN since
-      i++;                        // is_label checks
-    }
-    printf("Testing BASE ADDRESS >>%s<<\n", baseaddress);
-    if(is_label(baseaddress)){            // Check to see if it follows label
-      if(symbl = get_entry(baseaddress)){ // Check to see if existing label
-        if(symbl->type == REGTYPE){
-          error_count("ERROR: The base address cannot be a register:",
-		       baseaddress);
-          *mode = BAD_ADDR_MODE;
-        }
-        else{
-          flag_valid_base = TRUE; // At this point we know that the base is valid
-          #ifdef debug
-          printf("BASE ADDRESS >>%s<< KNOWN VALID\n", baseaddress);
-          #endif
-        }
-      }
-      else{
-        flag_valid_base = TRUE;
-        #ifdef debug
-        printf("BASE ADDRESS >>%s<< UNKNOWN VALID\n", baseaddress);
-        #endif /* debug */
-        add_entry(baseaddress, 0, UNKTYPE); // Add the forward reference
-      }
-    }
-    else{
-      error_count("ERROR: Base Address Invalid:", baseaddress);
-      *mode = BAD_ADDR_MODE;
-    }
+  name = malloc(op->sym_len + 1);
+  memcpy(name, text + op->sym_start, op->sym_len);
+  name[op->sym_len] = NUL;
 
-    if(flag_valid_index && flag_valid_base){
-      #ifdef debug
-      printf("OPERAND >>%s<< INDEXED\n", operand);
-      #endif
-      *mode = INDEXED;
-    }
-  }   /* Ended searching for Indexed*/
+  if(!is_label(name)){                // Mnemonics cannot be used as symbols
+    error_count((char*)operand_errors[OPE_SYNTAX], text);
+    free(name);
+    op->mode = BAD_ADDR_MODE;
+    return FALSE;
+  }
 
-  else if((is_number(operand)) != EXIT_FAIL){
+  symbl = insert_entry(name, 0, UNKTYPE, &inserted);
+  if(inserted){
     #ifdef debug
-    printf("OPERAND >>%s<< NUMERIC RELATIVE\n", operand);
-    #endif
-    *mode = RELATIVE;
+    printf("OPERAND >>%s<< UNKNOWN LABEL\n", name);
+    #endif /* debug */
   }
-
-  else{
-    error_count("ERROR: Operand Unindentifiable:", operand);
-    *mode = BAD_ADDR_MODE;
+  else if(op->mode == IMMEDIATE && symbl->type == LBLTYPE &&
+          CONGEN(symbl->value)){
+    op->constgen = TRUE;
+    op->value = symbl->value;         // Labels never change once defined
   }
+  op->symbol = symbl->id;
+  free(name);
+  return TRUE;
 }
 
-void checkjump(char* line, char* jumpinst){
+void checkjump(char* line, struct inst_el* jumpinst){
   char* token;
   int value;
   token = strtok(line, " \t\r\n");
@@ -643,14 +768,14 @@ void checkjump(char* line, char* jumpinst){
       printf("%s is an unknown label\n", token);
     }
     // Adds the operand and instruction to the record list for the second pass
-    add_jump_record(jumpinst, JUMP, token);
+    add_jump_record(jumpinst, token);
     (LC + WORD_INC) <= MAX_LC ? LC+=WORD_INC : (flag_max_lc = TRUE);
   }
-  else if((value = is_number(line)) != EXIT_FAIL){
+  else if(parse_literal(token, &value) == NUM_OK){
     printf("RETURNED value %d\n", value);
     printf("%s is a numerical jump\n", token);
     // Adds the operand and instruction to the record list for the second pass
-    add_jump_record(jumpinst, JUMP, token);
+    add_jump_record(jumpinst, token);
     (LC + WORD_INC) <= MAX_LC ? LC+=WORD_INC : (flag_max_lc = TRUE);
   }
   else{
@@ -672,23 +797,38 @@ unsigned char checkjunkrecord(char* line){
   }
 }
 
+/* Descriptor of a mode, constant generator immediates have their own */
+const struct mode_desc* mode_desc_of(enum ADDR_MODE mode,
+                                     unsigned char constgen, int value){
+  return &mode_descs[constgen ? cg_rows[value + 1] : mode];
+}
+
+const struct mode_desc* operand_desc(const struct operand* op){
+  return mode_desc_of(op->mode, op->constgen, op->value);
+}
+
 /*
-  Increase the LC by 2 for every instruction is incorporated in the SRC increase.
-  This function currently only deals with SINGLE and DOUBLE OP instructions.
+  Size in bytes of an instruction: 2 plus 2 for every extension word of its
+  operands. dst is NULL for single operand instructions.
 */
+unsigned instruction_size(struct operand* src, struct operand* dst){
+  unsigned size = WORD_INC * (1 + operand_desc(src)->ext_words);
 
-void incrementLC(enum ADDR_MODE* src_addr, enum ADDR_MODE* dst_addr){
-  //{REGISTER, INDEXED, RELATIVE, ABSOLUTE, INDIRECT, INDIRECT_INCR, IMMEDIATE}
-  unsigned char LC_INCREMENTS[] = {0, 2, 2, 2, 0, 0, 2};
-  printf("LC_INCREMENTS[%d]: %d\n", *src_addr, LC_INCREMENTS[*src_addr]);
-  printf("LC_INCREMENTS[%d]: %d\n", *dst_addr, LC_INCREMENTS[*dst_addr]);
+  if(dst){
+    size += WORD_INC * operand_desc(dst)->ext_words;
+  }
+  return size;
+}
+
+/* Advances the LC past an instruction of size bytes */
+void incrementLC(unsigned size){
+  #ifdef debug
+  printf("LC increment: %d\n", size);
+  #endif /* debug */
 
-  //No need to have a special case for no DST since DST NULL will up the LC
-  //by the REG amount of 0
   if(!flag_max_lc){
-    LC += (WORD_INC + LC_INCREMENTS[*src_addr] + LC_INCREMENTS[*dst_addr]
-      -2*flag_const_immediate); //not a very elegant solution to const_gen value
-  }                             //but it works more efficiently than conditionals
+    LC += size;
+  }
 
   if(LC >= MAX_LC){
     flag_max_lc = TRUE;
@@ -8,37 +8,143 @@
 
   Coder: Elias Vonapartis
   Release Date: May 28, 2016
-  Latest Updates: None
+  Latest Updates: Oct 19, 2026  - Added the operand classifier
+                                - Mnemonics are fixed width keys
+                                - Base mnemonics with allowed suffixes
+                                - Added the classified line of the first pass
+                                - Operands refer to symbols by ID
+                                - Encoding templates kept with the mnemonics
+                                - Added the addressing mode descriptors
+                                - Added the emulated mnemonics
 */
 
 #include "assembler.h"
 #include "parser.h"
 
 /* Definitions */
-#define LASTINST "ZZZ"
 #define MAX_BIT_VAL 65535
-#define REG_SIZE 3
 #define WORD_INC 2
+#define LISTLENGTH 55
+#define INST_SLOT_BITS 8
+#define INST_SLOTS (1 << INST_SLOT_BITS)
 
-unsigned char flag_const_immediate;
+/* Size suffixes a mnemonic accepts */
+#define SUFFIX_NONE 0x00
+#define SUFFIX_W    0x01
+#define SUFFIX_B    0x02
+#define SUFFIX_WB   (SUFFIX_W | SUFFIX_B)
+
+/* Character classes seen by the operand classifier */
+enum CHAR_CLASS {CC_OTHER, CC_ALPHA, CC_DIGIT, CC_HASH, CC_AMP, CC_AT, CC_PLUS,
+                 CC_OPEN, CC_CLOSE, CC_NUMBER, CC_END, CC_LAST};
+
+enum OPERAND_ERROR {OPE_NONE, OPE_MISSING, OPE_SYNTAX, OPE_LITERAL, OPE_RANGE,
+                    OPE_NOT_REG, OPE_REG_VALUE, OPE_NOT_INDEX, OPE_BASE_REG,
+                    OPE_PAREN, OPE_LONG};
+
+/*
+  Everything the passes need to know about an operand. classify_operand() fills
+  in all but symbol, the ID given to the symbol span by resolve_operand() once
+  the symbol has been interned.
+*/
+struct operand{
+  enum ADDR_MODE mode;
+  signed char reg;            // Register named by the operand or NO_REG
+  int value;                  // Literal value, 0 when a symbol is used
+  unsigned short sym_start;   // Symbol span within the operand text,
+  unsigned short sym_len;     // sym_len is 0 when there is no symbol
+                              // value is also set for a constgen symbol
+  unsigned symbol;            // Symbol ID or NO_SYMBOL
+  unsigned char constgen;     // Immediate supplied by the constant generator
+  enum OPERAND_ERROR error;
+};
+
+/*
+  A source line as classified by classify_line() in the parallel step of the
+  first pass. Lines holding an instruction, with or without a label, are
+  classified there. Everything else is LINE_PARSE and goes through
+  parse_record() in the sequential sweep, as does any line whose instruction
+  part is malformed, so its errors are reported in order.
+*/
+enum LINE_KIND {LINE_PARSE, LINE_INST};
+
+struct line_info{
+  const char* start;          // Line within the source buffer
+  unsigned short length;      // Newline excluded, truncated to fit LINE_LEN
+  enum LINE_KIND kind;
+  char* label;                // Label in front of the instruction, or NULL
+  struct firsttoken token;
+  char* operands;             // Operand field, split for SINGLE and DOUBLE
+  char* src_text;
+  char* dst_text;
+  struct operand src;
+  struct operand dst;
+};
+
+/*
+  Rows of the addressing mode descriptor table. The addressing modes come
+  first, then the immediates supplied by the constant generator.
+*/
+enum MODE_ROW {CG_MINUS_ONE = BAD_ADDR_MODE + 1, CG_ZERO, CG_ONE, CG_TWO,
+               CG_FOUR, CG_EIGHT, MODE_ROWS};
+
+/* What an operand's mode means for the encoding and size of an instruction */
+struct mode_desc{
+  unsigned char as;           // As bits as a source
+  unsigned char ad;           // Ad bit as a destination
+  signed char reg;            // Register implied by the mode, or NO_REG
+  unsigned char ext_words;    // Extension words the operand adds
+  unsigned char pc_bias;      // A relative offset is taken from the LC plus
+                              // this many bytes, 0 if not PC relative
+  unsigned char dst_ok;       // Allowed as a destination
+};
+
+/*
+  What an emulated mnemonic assembles as, a core double operand instruction
+  with a constant generator source or a fixed register. A NULL operand is the
+  one written, which is both for RLA and RLC as they add it to itself. core is
+  NULL for the core mnemonics.
+*/
+struct emulation{
+  const char* core;
+  const char* src;
+  const char* dst;
+};
 
 struct inst_el{
-  char *inst;
-  unsigned short opcode;
-  enum INST_TYPE type;
-  enum BYTE_COMB bw;
+  char inst[KEY_LEN];       // Upper case and NUL padded, see make_key()
+  unsigned short opcode;    // Emulated: encoding with R5, see selftest
+  enum INST_TYPE type;      // Operands as written
+  unsigned char widths;     // SUFFIX_ flags
+  struct emulation emul;
+  unsigned short encoding[2]; // Template per width, see init_encoder()
 };
 
+extern struct inst_el inst_list[LISTLENGTH];
+
 /* External Functions */
+void init_inst_index(void);
 struct inst_el* get_inst(char*);
-void analyzeinstruction(char* , struct firsttoken);
-void operand_parser(char* , enum INST_TYPE, char* );
+struct inst_el* get_inst_key(const struct token_key* );
+const char* check_suffix(struct inst_el* , const struct token_key* ,
+                         enum BYTE_COMB* );
+unsigned char decode_suffix(struct inst_el* , const struct token_key* , char* ,
+                            enum BYTE_COMB* );
+void analyzeinstruction(char* , struct firsttoken, struct line_info* );
+void operand_parser(char* , enum INST_TYPE, struct firsttoken );
+void emulated_operands(const struct emulation* , char* , const struct operand* ,
+                       char** , struct operand* , char** , struct operand* );
+void commit_emulated(struct firsttoken , char* , struct operand* );
+void commit_operands(struct firsttoken , enum INST_TYPE , char* , char* ,
+                     struct operand* , struct operand* );
+const char* split_operands(char* , enum INST_TYPE , char** , char** );
 unsigned char tokenize_operands(char* , enum INST_TYPE , char** , char** );
-void checkabsolute(char* , enum ADDR_MODE* );
-void checkindirect(char* , enum ADDR_MODE* );
-void checkimmediate(char* , enum ADDR_MODE* );
-void checkdefault(char* , enum ADDR_MODE* );
-void checkjump(char* , char* );
+void classify_operand(const char* , struct operand* );
+unsigned char resolve_operand(char* , struct operand* );
+const struct mode_desc* mode_desc_of(enum ADDR_MODE , unsigned char , int );
+const struct mode_desc* operand_desc(const struct operand* );
+void checkjump(char* , struct inst_el* );
 unsigned char checkjunkrecord(char* );
-void incrementLC(enum ADDR_MODE* , enum ADDR_MODE* );
+unsigned instruction_size(struct operand* , struct operand* );
+void incrementLC(unsigned );
 #endif /* INSTRUCTIONS_H */
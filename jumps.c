@@ -0,0 +1,377 @@
+/*
+  jumps.c
+  Optional passes over the jumps of the first pass records, run once every
+  label is known and before the second pass. relax_jumps() gives the jumps
+  whose target is out of reach a long form through a BR. thread_jumps() sends
+  the jumps whose target is another unconditional jump straight on to where
+  that one goes.
+
+  Coder: Elias Vonapartis
+  Release Date: Oct 19, 2026
+  Latest Updates: Oct 19, 2026  - Added jump threading
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "assembler.h"
+#include "parser.h"
+#include "instructions.h"
+#include "symboltable.h"
+#include "records.h"
+#include "secondpass.h"
+#include "errors.h"
+#include "emit.h"
+#include "jumps.h"
+
+/*
+  The condition jumps and the jump on the opposite condition, which skips the
+  BR of the long form. JN has none, it is handled through a JMP.
+*/
+static const char* inverse_jumps[][2] = {
+  {"JNE", "JEQ"}, {"JNZ", "JZ"}, {"JEQ", "JNE"}, {"JZ", "JNZ"},
+  {"JC", "JNC"}, {"JHS", "JLO"}, {"JNC", "JC"}, {"JLO", "JHS"},
+  {"JGE", "JL"}, {"JL", "JGE"}
+};
+
+/* Entry of the jump on the opposite condition, NULL for JMP and JN */
+static struct inst_el* inverse_of(const struct inst_el* instptr){
+  unsigned i;
+
+  for(i = 0; i < sizeof(inverse_jumps) / sizeof(inverse_jumps[0]); i++){
+    if(strcmp(instptr->inst, inverse_jumps[i][0]) == 0){
+      return get_inst((char* )inverse_jumps[i][1]);
+    }
+  }
+  return NULL;
+}
+
+/* Encodes a short jump of the given word offset */
+static unsigned short short_jump(const struct inst_el* instptr, short offset){
+  struct inst_fields fields;
+
+  fields.encoding = instptr->encoding[WORD];
+  fields.type = JUMP;
+  fields.offset = offset;
+  return encode_inst(&fields);
+}
+
+/* Encodes BR #target, that is MOV #target,PC, without its extension word */
+static unsigned short branch_word(void){
+  struct inst_fields fields;
+
+  fields.encoding = get_inst("MOV")->encoding[WORD];
+  fields.type = DOUBLE;
+  fields.src = PC_REG;
+  fields.as = mode_desc_of(IMMEDIATE, FALSE, 0)->as;
+  fields.ad = mode_desc_of(REGISTER, FALSE, 0)->ad;
+  fields.dst = PC_REG;
+  return encode_inst(&fields);
+}
+
+/* Size in bytes of a jump in its current form */
+unsigned jump_size(const struct jump_record* jump){
+  unsigned short words[LONG_JUMP_WORDS];
+
+  if(jump->form == JUMP_SHORT){
+    return WORDINC;
+  }
+  return WORDINC * long_jump_words(jump, words);
+}
+
+/*
+  Writes the words of a long jump to words and returns how many there are. JMP
+  becomes a BR, a condition jump skips the BR on the opposite condition, and JN
+  jumps over a JMP which skips the BR:
+      JMP t     BR #t
+      JEQ t     JNE $+6, BR #t
+      JN t      JN $+4, JMP $+6, BR #t
+*/
+unsigned long_jump_words(const struct jump_record* jump, unsigned short* words){
+  struct inst_el* instptr = &inst_list[jump->inst];
+  struct inst_el* inverse;
+  unsigned count = 0;
+
+  if(strcmp(instptr->inst, "JN") == 0){
+    words[count++] = short_jump(instptr, 1);
+    words[count++] = short_jump(get_inst("JMP"), 2);
+  }
+  else if((inverse = inverse_of(instptr))){
+    words[count++] = short_jump(inverse, 2);
+  }
+  words[count++] = branch_word();
+  words[count++] = jump->offset;
+  return count;
+}
+
+/* Lists the long form of a jump as its instructions */
+void print_long_jump(const struct jump_record* jump){
+  struct inst_el* instptr = &inst_list[jump->inst];
+  struct inst_el* inverse;
+
+  if(strcmp(instptr->inst, "JN") == 0){
+    fprintf(fout, "JN $+4, JMP $+6, ");
+  }
+  else if((inverse = inverse_of(instptr))){
+    fprintf(fout, "%s $+6, ", inverse->inst);
+  }
+  fprintf(fout, "BR #%04x\n", jump->offset);
+}
+
+/* Target of a jump, given the shift of its label when it has one */
+static unsigned short jump_target(struct jump_record* jump, const int* shift){
+  struct symbol_entry* stptr;
+
+  if(jump->symbol != NO_SYMBOL && (stptr = symbol_by_id(jump->symbol)) &&
+     stptr->type == LBLTYPE && stptr->anchor != NO_RECORD){
+    return stptr->value + shift[stptr->anchor];
+  }
+  return jump->offset;
+}
+
+/*
+  Jump relaxation. A short jump reaches 512 words either way, so a jump whose
+  target is farther is given its long form. Growing a jump moves everything
+  after it, up to the next ORG, which can put other jumps out of reach, so the
+  layout is redone until no more jumps grow. Jumps never shrink back, so this
+  ends. The records and labels are then moved, and every rewrite is listed.
+  Returns FALSE if the result could not be laid out.
+*/
+unsigned char relax_jumps(void){
+  struct record_tag** tags;
+  struct jump_record* jump;
+  unsigned count = record_count();
+  unsigned iterations = 0;
+  unsigned relaxed = 0;
+  unsigned added = 0;
+  unsigned char changed;
+  unsigned char res;
+  short distance;
+  unsigned i;
+  int* growth;
+  int* shift;
+
+  tags = record_table();
+  growth = calloc(count + 1, sizeof(*growth));
+  shift = malloc((count + 1) * sizeof(*shift));
+
+  fprintf(fout, "\n--------------    Jump Relaxation    --------------\n");
+  do{
+    iterations++;
+    changed = FALSE;
+    layout_shifts(tags, count, growth, shift);
+    for(i = 0; i < count; i++){
+      jump = (struct jump_record*)tags[i];
+      if(tags[i]->kind != REC_JUMP || jump->form != JUMP_SHORT){
+        continue;
+      }
+      distance = jump_target(jump, shift) - (tags[i]->LC + shift[i] +
+                                             WORDINC);
+      if(distance >= MAX_POS_OFFSET || distance <= MAX_NEG_OFFSET){
+        jump->form = JUMP_LONG;
+        growth[i] = jump_size(jump) - WORDINC;
+        changed = TRUE;
+        relaxed++;
+      }
+    }
+  }while(changed);
+
+  res = move_symbols(tags, count, shift);
+
+  for(i = 0; i < count; i++){
+    jump = (struct jump_record*)tags[i];
+    if(tags[i]->kind == REC_JUMP && jump->form == JUMP_LONG){
+      fprintf(fout, "Line %d: %s %04x at %04x is out of reach, now ",
+              tags[i]->line, inst_list[jump->inst].inst, jump->offset,
+              tags[i]->LC);
+      print_long_jump(jump);
+      added += jump_size(jump) - WORDINC;
+    }
+  }
+  fprintf(fout, "Jumps relaxed: %u\t\tPasses: %u\t\tBytes added: %u\n",
+          relaxed, iterations, added);
+
+  free(tags);
+  free(growth);
+  free(shift);
+  return res;
+}
+
+/* TRUE if the record is BR #target, that is MOV #target,PC */
+static unsigned char is_branch(struct record_tag* tag){
+  struct inst_record* inst = (struct inst_record*)tag;
+
+  return tag->kind == REC_DOUBLE && strcmp(inst_list[inst->inst].inst,
+         "MOV") == 0 && inst->bw == WORD && inst->op[0].mode == IMMEDIATE &&
+         !inst->op[0].constgen && inst->op[1].mode == REGISTER &&
+         inst->op[1].reg == PC_REG;
+}
+
+/* Orders hops by address */
+int compare_hops(const void* a, const void* b){
+  return ((const struct hop*)a)->LC - ((const struct hop*)b)->LC;
+}
+
+/*
+  Collects the unconditional jumps of the records, JMP in either form and BR,
+  sorted by address. Their targets are copied, so the chains are followed as
+  they were written while the jumps get rewritten. Returns how many there are.
+*/
+unsigned collect_hops(struct hop** list){
+  struct record_tag* tag;
+  struct jump_record* jump;
+  struct inst_record* inst;
+  struct hop* hops = NULL;
+  unsigned count = 0;
+  unsigned size = 0;
+
+  for(tag = first_record(); tag; tag = next_record(tag)){
+    jump = (struct jump_record*)tag;
+    inst = (struct inst_record*)tag;
+    if(!(tag->kind == REC_JUMP && strcmp(inst_list[jump->inst].inst,
+                                         "JMP") == 0) && !is_branch(tag)){
+      continue;
+    }
+    if(count == size){
+      size = size ? size * 2 : HOPS_INIT;
+      hops = realloc(hops, size * sizeof(*hops));
+    }
+    hops[count].LC = tag->LC;
+    hops[count].visit = 0;
+    if(tag->kind == REC_JUMP){
+      hops[count].target = jump->offset;
+      hops[count].symbol = jump->symbol;
+      hops[count].cycles = jump->form == JUMP_SHORT ? JMP_CYCLES : BR_CYCLES;
+    }
+    else{
+      hops[count].target = inst->op[0].value;
+      hops[count].symbol = inst->op[0].symbol;
+      hops[count].cycles = BR_CYCLES;
+    }
+    count++;
+  }
+  if(count){
+    qsort(hops, count, sizeof(*hops), compare_hops);
+  }
+  *list = hops;
+  return count;
+}
+
+/* The unconditional jump at address, NULL if there is none */
+static struct hop* find_hop(struct hop* hops, unsigned count,
+                            unsigned short address){
+  struct hop key;
+
+  if(count == 0){
+    return NULL;
+  }
+  key.LC = address;
+  return bsearch(&key, hops, count, sizeof(*hops), compare_hops);
+}
+
+/*
+  Follows the chain of unconditional jumps from *target to its end. The
+  farthest target the jump at from can reach, any one if far, is stored back in
+  *target and *symbol. Returns the cycles saved by going there, with the hops
+  skipped in *skipped, or 0 if the target stays. A chain which loops, such as a
+  jump to itself, is left alone as it never ends.
+*/
+static unsigned follow_chain(struct hop* hops, unsigned count, unsigned stamp,
+                             unsigned short* target, unsigned* symbol,
+                             unsigned short from, unsigned char far,
+                             unsigned* skipped){
+  struct hop* hop;
+  unsigned short at = *target;
+  unsigned cycles = 0;
+  unsigned saved = 0;
+  unsigned steps = 0;
+  short distance;
+
+  *skipped = 0;
+  while((hop = find_hop(hops, count, at)) && hop->visit != stamp){
+    hop->visit = stamp;
+    cycles += hop->cycles;
+    steps++;
+    at = hop->target;
+    distance = at - (from + WORDINC);
+    if(at % 2 == 0 && (far || (distance < MAX_POS_OFFSET &&
+                               distance > MAX_NEG_OFFSET))){
+      *target = at;
+      *symbol = hop->symbol;
+      *skipped = steps;
+      saved = cycles;
+    }
+  }
+  return hop ? 0 : saved;
+}
+
+/*
+  Jump threading. A jump or BR going to an unconditional jump is sent on to
+  where that one goes, following the whole chain, as far as a short jump can
+  still reach. Run after relax_jumps() so the addresses are final. Every
+  rewrite is listed with the cycles each pass through it saves, a JMP being 2
+  cycles and a BR 3.
+*/
+void thread_jumps(void){
+  struct record_tag* tag;
+  struct jump_record* jump;
+  struct inst_record* inst;
+  struct hop* hops;
+  unsigned short target;
+  unsigned short before;
+  unsigned symbol;
+  unsigned count;
+  unsigned stamp = 0;
+  unsigned skipped;
+  unsigned saved;
+  unsigned threaded = 0;
+  unsigned total_hops = 0;
+  unsigned total_cycles = 0;
+
+  count = collect_hops(&hops);
+  fprintf(fout, "\n--------------    Jump Threading    --------------\n");
+
+  for(tag = first_record(); tag; tag = next_record(tag)){
+    jump = (struct jump_record*)tag;
+    inst = (struct inst_record*)tag;
+    if(tag->kind == REC_JUMP){
+      target = jump->offset;
+      symbol = jump->symbol;
+      saved = follow_chain(hops, count, ++stamp, &target, &symbol, tag->LC,
+                           jump->form == JUMP_LONG, &skipped);
+    }
+    else if(is_branch(tag)){
+      target = inst->op[0].value;
+      symbol = inst->op[0].symbol;
+      saved = follow_chain(hops, count, ++stamp, &target, &symbol, tag->LC,
+                           TRUE, &skipped);
+      saved = CONGEN(target) ? 0 : saved;   // Would change the size
+    }
+    else{
+      continue;
+    }
+    if(!saved){
+      continue;
+    }
+
+    if(tag->kind == REC_JUMP){
+      before = jump->offset;
+      jump->offset = target;
+      jump->symbol = symbol;
+    }
+    else{
+      before = inst->op[0].value;
+      inst->op[0].value = target;
+      inst->op[0].symbol = symbol;
+    }
+    fprintf(fout, "Line %d: %s %04x goes through %u jump(s), now %04x, "
+            "%u cycles saved\n", tag->line, tag->kind == REC_JUMP ?
+            inst_list[jump->inst].inst : "BR", before, skipped, target, saved);
+    threaded++;
+    total_hops += skipped;
+    total_cycles += saved;
+  }
+  fprintf(fout, "Jumps threaded: %u\t\tJumps skipped: %u\t\tCycles saved: "
+          "%u\n", threaded, total_hops, total_cycles);
+  free(hops);
+}
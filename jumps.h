@@ -0,0 +1,38 @@
+#ifndef JUMPS_H
+#define JUMPS_H
+
+/*
+  jumps.h
+  Header file for jumps.c
+
+  Coder: Elias Vonapartis
+  Release Date: Oct 19, 2026
+  Latest Updates: Oct 19, 2026  - Added jump threading
+*/
+
+#include "records.h"
+
+#define LONG_JUMP_WORDS 4       // Most words of a long jump, that of JN
+#define JMP_CYCLES      2
+#define BR_CYCLES       3       // MOV #target,PC
+#define HOPS_INIT       64
+
+/* An unconditional jump, which jump threading can skip */
+struct hop{
+  unsigned short LC;
+  unsigned short target;
+  unsigned symbol;              // Label of the target or NO_SYMBOL
+  unsigned char cycles;         // Cycles it takes
+  unsigned visit;               // Last chain it was seen in, for loops
+};
+
+/* Function Declarations */
+unsigned char relax_jumps(void);
+unsigned jump_size(const struct jump_record* );
+unsigned long_jump_words(const struct jump_record* , unsigned short* );
+void print_long_jump(const struct jump_record* );
+void thread_jumps(void);
+int compare_hops(const void* , const void* );
+unsigned collect_hops(struct hop** );
+
+#endif /* JUMPS_H */
@@ -0,0 +1,86 @@
+/*
+  parallel.c
+  Small worker pool used by the assembler for work which can be split into
+  independent ranges, such as formatting the s-records of the image. Each
+  worker gets one contiguous range so results stay in order for the caller.
+
+  Coder: Elias Vonapartis
+  Release Date: Oct 19, 2026
+  Latest Updates: None
+*/
+
+#include <stdio.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "parallel.h"
+
+struct range_job{
+  range_work work;
+  void* arg;
+  unsigned begin;
+  unsigned end;
+};
+
+/* Number of workers to use, the online processors up to MAX_THREADS */
+unsigned thread_count(void){
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+  if(cpus < 1){
+    return 1;
+  }
+  return (cpus > MAX_THREADS) ? MAX_THREADS : cpus;
+}
+
+static void* run_job(void* job){
+  struct range_job* range = job;
+
+  range->work(range->begin, range->end, range->arg);
+  return NULL;
+}
+
+/*
+  Splits [0, count) into one range per worker and waits for all of them. Each
+  worker receives at least min_per_thread items, so small counts are simply run
+  on the calling thread. The last range is always run on the calling thread.
+*/
+void parallel_for(unsigned count, unsigned min_per_thread, range_work work,
+                  void* arg){
+  pthread_t threads[MAX_THREADS];
+  struct range_job jobs[MAX_THREADS];
+  unsigned char started[MAX_THREADS];
+  unsigned workers = thread_count();
+  unsigned i;
+
+  if(min_per_thread == 0){
+    min_per_thread = 1;
+  }
+  if(count / min_per_thread < workers){
+    workers = count / min_per_thread;
+  }
+  if(workers <= 1){
+    work(0, count, arg);
+    return;
+  }
+
+  for(i = 0; i < workers; i++){
+    jobs[i].work = work;
+    jobs[i].arg = arg;
+    jobs[i].begin = (unsigned long)count * i / workers;
+    jobs[i].end = (unsigned long)count * (i + 1) / workers;
+    started[i] = 0;
+  }
+
+  for(i = 0; i < workers - 1; i++){
+    started[i] = (pthread_create(&threads[i], NULL, run_job, &jobs[i]) == 0);
+    if(!started[i]){
+      run_job(&jobs[i]);        // Fall back to doing the range here
+    }
+  }
+  run_job(&jobs[workers - 1]);
+
+  for(i = 0; i < workers - 1; i++){
+    if(started[i]){
+      pthread_join(threads[i], NULL);
+    }
+  }
+}
@@ -0,0 +1,22 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+/*
+  parallel.h
+  Header file for parallel.c
+
+  Coder: Elias Vonapartis
+  Release Date: Oct 19, 2026
+  Latest Updates: None
+*/
+
+#define MAX_THREADS   8
+
+/* Work function, called with a range [begin, end) and the caller's argument */
+typedef void (*range_work)(unsigned, unsigned, void* );
+
+/* Function Declarations */
+unsigned thread_count(void);
+void parallel_for(unsigned , unsigned , range_work , void* );
+
+#endif /* PARALLEL_H */
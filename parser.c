@@ -5,91 +5,343 @@
 
   Coder: Elias Vonapartis
   Release Date: May 28, 2016
-  Latest Updates: None
+  Latest Updates: Oct 19, 2026  - Records and tokens located by scanner.c
+                                - Tokens case folded into lookup keys
+                                - Size suffixes split off the keys
+                                - Records classified in parallel, then swept
+                                  in order to assign the LCs
+                                - Repeated instruction lines are copied from
+                                  a cache instead of being classified again
+                                - Record count and size in the statistics
 */
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <stdatomic.h>
 #include "parser.h"
 #include "instructions.h"
 #include "directives.h"
 #include "symboltable.h"
 #include "errors.h"
+#include "scanner.h"
+#include "parallel.h"
+#include "records.h"
+
+static atomic_uint cache_hits;      // Line cache totals of all the ranges
+static atomic_uint cache_misses;
 
 /*
-  firstpass() reads the input assembly file and calls the parser to tokenize
-  and analyze each record separetely.
+  firstpass() reads the input assembly file and splits it into records with
+  the block scanner. It then runs in two steps. classify_lines() classifies
+  the records in parallel, touching nothing but its own records.
+  A sequential sweep then assigns the LCs in order, defining labels, resolving
+  symbols and reporting errors as it goes.
 */
 void firstpass(FILE* fp){
-  char instring[LINE_LEN];
+  char instring[LINE_LEN] = {0};
+  struct file_scan scan;
+  struct line_info* lines;
+  const char* start;
+  size_t length;
+  size_t size;
+  unsigned count = 0;
+  unsigned capacity = 1024;
+  unsigned i;
+  char* source;
 
   //Initializing Globals
   flag_end_of_program = FALSE; // Used to end assembly when END is encountered
   flag_max_lc = FALSE;
   line_number = 1;             // Numbers in this case = Readable
   errors = 0;
+  start_symbol = NO_SYMBOL;     // Set by END if it names a label
+  atomic_store(&cache_hits, 0);
+  atomic_store(&cache_misses, 0);
 
   fprintf(fout,"\n--------------    Input Records    --------------\n");
 
-  while((fgets(instring, LINE_LEN, fp) != NULL) && flag_end_of_program == FALSE){
-    /* Truncate lines too long */
-    instring[LINE_LEN-1] = NUL;
+  source = readsource(fp, &size);
+  start_file_scan(&scan, source, size);
+  lines = malloc(capacity * sizeof(struct line_info));
+
+  while(next_line(&scan, &start, &length)){
+    if(count == capacity){
+      capacity *= 2;
+      lines = realloc(lines, capacity * sizeof(struct line_info));
+    }
+    /* Truncate lines too long, the record keeps its newline */
+    lines[count].start = start;
+    lines[count].length = (length > LINE_LEN - 2) ? LINE_LEN - 2 : length;
+    count++;
+  }
+
+  parallel_for(count, PARALLEL_MIN_LINES, classify_lines, lines);
+
+  for(i = 0; i < count && flag_end_of_program == FALSE; i++){
+    copy_line(&lines[i], instring);
     #ifdef debug
     printf("\n------Record %d------: %s", line_number, instring);
     #endif
     fprintf(fout, "\n------Record %d------: %s", line_number, instring);
     /* Completely skip record if it starts with a comment or it's a blank */
     if((instring[0] != '\r') && (instring[0] != ';') && (instring[0] != '\n')){
+      if(lines[i].kind == LINE_INST){
+        commit_line(&lines[i]);
+      }
+      else{
         parse_record(instring);
+      }
     }
     line_number++; // Line number is incremented regardless of blank or not
   }
+  free(lines);
+  free(source);
 }
 
-void parse_record(char* line){
-  char *token;
-  char *string;
-  char *strptr;
-  unsigned short safeguard = 0;
-  struct firsttoken tokinfo;
+/* Copies a line into a record buffer, adding the newline back */
+void copy_line(struct line_info* line, char* record){
+  memcpy(record, line->start, line->length);
+  record[line->length] = '\n';
+  record[line->length + 1] = NUL;
+}
 
-  string = storeline(line);      //Store the record for error printing purposes
+/*
+  parallel_for() work function, classifies the lines [begin, end). Each range
+  has its own line cache, so a line only hits on text repeated in its range.
+*/
+void classify_lines(unsigned begin, unsigned end, void* arg){
+  struct line_info* lines = arg;
+  struct line_cache* cache = calloc(1, sizeof(struct line_cache));
+  unsigned i;
 
-  token = strtok(line, " \t\r\n"); // Isolate the token for analysis
+  for(i = begin; i < end; i++){
+    classify_line(&lines[i], cache);
+  }
+  atomic_fetch_add(&cache_hits, cache->hits);
+  atomic_fetch_add(&cache_misses, cache->misses);
+  free(cache);
+}
 
-  while(!isalnum(*string)){       // Go to first legible alphanumeric
-    *string++;
-    if(safeguard++ == LINE_LEN){
-      break;
+/*
+  Gives line the classification of the cached line, which has the same text
+  after its label. The operand field is copied with the NULs split_operands()
+  put in it, so the operand texts are found at the same offsets.
+*/
+static void copy_classified(struct line_info* line,
+                            struct line_cache_entry* entry){
+  struct line_info* cached = entry->line;
+
+  line->token = cached->token;
+  line->src = cached->src;
+  line->dst = cached->dst;
+  line->operands = malloc(entry->operands_len + 1);
+  memcpy(line->operands, cached->operands, entry->operands_len + 1);
+  line->src_text = cached->src_text ?
+                   line->operands + (cached->src_text - cached->operands) : NULL;
+  line->dst_text = cached->dst_text ?
+                   line->operands + (cached->dst_text - cached->operands) : NULL;
+}
+
+/*
+  Classifies a line holding an instruction, with or without a label, down to
+  its operands. This runs on several threads at once so it must not touch the
+  symbol table, the records, the LC or the error count. Lines it cannot handle
+  completely are left as LINE_PARSE for the sweep. Once the label, if any, has
+  been found the rest of the line is looked up in cache, a hit skipping the
+  instruction and its operands. Only lines classified as LINE_INST are cached,
+  the symbols of the operands are resolved for each line by the sweep.
+*/
+void classify_line(struct line_info* line, struct line_cache* cache){
+  char record[LINE_LEN];
+  struct line_scan scan;
+  struct token_key key;
+  struct inst_el* instptr = NULL;
+  struct line_cache_entry* entry;
+  const char* text;
+  unsigned start;
+  unsigned end;
+  unsigned length;
+  unsigned hash;
+  unsigned label_start = 0;
+  unsigned label_end = 0;
+  char delim;
+
+  line->kind = LINE_PARSE;
+  line->label = NULL;
+
+  copy_line(line, record);
+  if(record[0] == '\r' || record[0] == ';' || record[0] == '\n'){
+    return;
+  }
+  scan_line(record, &scan);
+  start = skip_delims(&scan, 0);
+  if(start == scan.length){
+    return;
+  }
+  end = find_delim(&scan, start);
+  delim = record[end];
+  record[end] = NUL;
+  make_key(record + start, &key);
+
+  if(!(instptr = get_inst_key(&key))){
+    if(get_dir_key(&key)){
+      return;
     }
+    label_start = start;                // Otherwise it should be a label
+    label_end = end;
+    start = skip_delims(&scan, end);
+    if(start == scan.length){
+      return;
+    }
+    end = find_delim(&scan, start);
   }
 
-  strptr = storeline(string + strlen(token)); // Store the record minus the
-                                              // 1st token for analysis in
-                                              // subsequent parsers
-  if(token != NULL){
-    /* Specify 1st token type in record (INST, DIR, LABEL, ERROR) */
-    tokinfo = sort(token);
-    switch (tokinfo.type) {
-      case INST:
-      analyzeinstruction(strptr, tokinfo);
-      break;
-      case DIR:
-      analyzedirective(strptr, tokinfo);
-      break;
-      case LABEL:
-      analyzelabel(strptr, token);
-      break;
-      case COMMENT:
+  // The cache key, from the instruction on without the comment or blanks
+  length = (scan.length < line->length) ? scan.length : line->length;
+  while(length > start && isspace((unsigned char)line->start[length - 1])){
+    length--;
+  }
+  text = line->start + start;
+  length -= start;
+  hash = hash_text(text, length);
+  entry = &cache->slot[hash & (LINE_CACHE_SLOTS - 1)];
+
+  if(entry->text && entry->hash == hash && entry->length == length &&
+     memcmp(entry->text, text, length) == 0){
+    cache->hits++;
+    copy_classified(line, entry);
+  }
+  else{
+    cache->misses++;
+    if(instptr == NULL){                // Token after the label
+      delim = record[end];
+      record[end] = NUL;
+      make_key(record + start, &key);
+      if(!(instptr = get_inst_key(&key))){
+        return;
+      }
+    }
+    if(check_suffix(instptr, &key, &line->token.bw)){
+      return;
+    }
+
+    // The operand field as parse_record() would have stored it
+    record[end] = delim;
+    line->operands = storeline(record + end);
+    line->src_text = NULL;
+    line->dst_text = NULL;
+
+    if(instptr->type == SINGLE || instptr->type == DOUBLE){
+      if(split_operands(line->operands, instptr->type, &line->src_text,
+                        &line->dst_text)){
+        free(line->operands);
+        return;
+      }
+      classify_operand(line->src_text, &line->src);
+      if(instptr->type == DOUBLE){
+        classify_operand(line->dst_text, &line->dst);
+      }
+    }
+    line->token.type = INST;
+    line->token.instptr = instptr;
+    line->token.dirptr = NULL;
+
+    entry->text = text;
+    entry->length = length;
+    entry->hash = hash;
+    entry->line = line;
+    entry->operands_len = strlen(record + end);
+  }
+
+  if(label_end){
+    line->label = malloc(label_end - label_start + 1);
+    memcpy(line->label, record + label_start, label_end - label_start);
+    line->label[label_end - label_start] = NUL;
+  }
+  line->kind = LINE_INST;
+}
+
+/*
+  The sweep's handling of a LINE_INST line. The label gets the checks sort()
+  would give it in parse_record(), then the instruction is analyzed with the
+  operands already classified.
+*/
+void commit_line(struct line_info* line){
+  if(line->label){
+    if(sort(line->label).type != LABEL){
+      error_count("ERROR: Unclassifiable first token >>%s<< in line",
+                  line->label);
       return;
-      break;
-      default:
-      error_count("ERROR: Unclassifiable first token >>%s<< in line", token);
-      break;
     }
-    token = strtok(NULL, " \t\n");
+    global = line->label;
+    flag_first_token_label = TRUE;
+  }
+  analyzeinstruction(line->operands, line->token, line);
+  flag_first_token_label = FALSE;
+  global = NULL;
+}
+
+/*
+  Reads the whole input file into one buffer, returning its size in size. The
+  caller frees the buffer.
+*/
+char* readsource(FILE* fp, size_t* size){
+  size_t capacity = 4096;
+  size_t count;
+  char* buffer = malloc(capacity);
+
+  *size = 0;
+  while((count = fread(buffer + *size, 1, capacity - *size, fp)) > 0){
+    *size += count;
+    if(*size == capacity){
+      capacity *= 2;
+      buffer = realloc(buffer, capacity);
+    }
+  }
+  return buffer;
+}
+
+/*
+  parse_record() locates the delimiters of the record with the block scanner,
+  which also cuts off any comment. The first token is then found by bit scans
+  and classified, the rest of the record going to the analyzers.
+*/
+void parse_record(char* line){
+  struct line_scan scan;
+  char *token;
+  char *strptr;
+  unsigned start;
+  unsigned end;
+  struct firsttoken tokinfo;
+
+  scan_line(line, &scan);
+  start = skip_delims(&scan, 0);
+  if(start == scan.length){           // Nothing before the comment
+    return;
+  }
+  end = find_delim(&scan, start);
+
+  strptr = storeline(line + end);     // Store the record minus the 1st token
+  line[end] = NUL;                    // for analysis in subsequent parsers
+  token = line + start;
+
+  /* Specify 1st token type in record (INST, DIR, LABEL, ERROR) */
+  tokinfo = sort(token);
+  switch (tokinfo.type) {
+    case INST:
+    analyzeinstruction(strptr, tokinfo, NULL);
+    break;
+    case DIR:
+    analyzedirective(strptr, tokinfo);
+    break;
+    case LABEL:
+    analyzelabel(&scan, end, token);
+    break;
+    default:
+    error_count("ERROR: Unclassifiable first token >>%s<< in line", token);
+    break;
   }
   #ifdef debug
   printf("LC after record %d\n", LC);
@@ -106,19 +358,23 @@ void parse_record(char* line){
 struct firsttoken sort(char *token){
   struct firsttoken result;
   struct symbol_entry* entry;
+  struct token_key key;
   result.instptr = NULL;
   result.dirptr = NULL;
   result.type = UNKNOWN;
+  result.bw = WORD;
 
-  if(result.instptr = get_inst(token)){       //Check INST list
+  make_key(token, &key);                      // Case folded once for all
+  if(result.instptr = get_inst_key(&key)){    //Check INST list
     result.type = INST;
+    decode_suffix(result.instptr, &key, token, &result.bw);
     return result;
   }
-  else if(result.dirptr = get_dir(token)){    //Check DIR list
+  else if(result.dirptr = get_dir_key(&key)){ //Check DIR list
     result.type = DIR;
     return result;
   }
-  else if(is_label(token)){                   //Check Label rules
+  else if(is_label_key(token, &key)){         //Check Label rules
     result.type = LABEL;
     if(entry = get_entry(token)){
       if(entry->type == REGTYPE){       //Ensures that the "valid" label is
@@ -127,21 +383,20 @@ struct firsttoken sort(char *token){
     }
     return result;
   }
-  else if(*token = ';'){                //For the cases in which the comment
-    result.type = COMMENT;              //starts further into the line
-  }
   return result;                        //If none of the above return UNKNOWN
 }
 
 /*
   If a label is encountered in parse_record, this function gets called to deal
-  with the remaining record. The following tokens in the record can be either
-  an instruction, a directive or a comment/null. Anything else is an error
+  with the remaining record, starting at pos of the scanned record. The
+  following tokens in the record can be either an instruction, a directive or
+  nothing. Anything else is an error
 */
-void analyzelabel(char* line, char* token){
+void analyzelabel(struct line_scan* scan, unsigned pos, char* token){
   char* nexttoken;
-  char* string;
   char* strptr;
+  unsigned start;
+  unsigned end;
   struct firsttoken result;
 
   #ifdef debug
@@ -149,18 +404,16 @@ void analyzelabel(char* line, char* token){
   #endif /* debug */
 
   global = token;                       // Global string saving the label token
-  string = storeline(line);
-  nexttoken = strtok(line, " \t\r\n");
-
-  if(nexttoken != NULL && *nexttoken != ';' && nexttoken[0] != '\r'){
+  start = skip_delims(scan, pos);
 
-    while(!isalnum(*string)){       // Go to first legible char
-      *string++;
-    }
+  if(start < scan->length){
+    end = find_delim(scan, start);
 
     //Points to the start of the next token for the analysis functions
 
-    strptr = storeline(string + strlen(nexttoken));
+    strptr = storeline(scan->text + end);
+    scan->text[end] = NUL;
+    nexttoken = scan->text + start;
 
     #ifdef debug
     printf("TOKEN AFTER LABEL IS >>%s<<\n", nexttoken);
@@ -171,7 +424,7 @@ void analyzelabel(char* line, char* token){
     flag_first_token_label = TRUE; // indicator used for storing in symtbl
     switch (result.type) {
       case INST:
-      analyzeinstruction(strptr, result);
+      analyzeinstruction(strptr, result, NULL);
       break;
       case DIR:
       analyzedirective(strptr, result);
@@ -186,17 +439,71 @@ void analyzelabel(char* line, char* token){
     #ifdef debug
     printf("SOLO LABEL >>%s<<\n", token);
     #endif
-    if(!get_entry(token)){            // If label unique, add it with LC
-      add_entry(token, LC, LBLTYPE);
-    }
-    else{
-      update_entry(token, LC, LBLTYPE);
-    }
+    define_label(token, LC, record_count()); // Resolves forward references
   }
 
   global = NULL; //Reset the global label for further usage
 }
 
+/*
+  Builds the lookup key of a token: the token up to any '.' folded to upper
+  case and padded with NULs to KEY_LEN, its hash and the size suffix. Mnemonics and directives are case
+  insensitive, so the folding is done here once and the tables are probed with
+  memcmp(). The token itself keeps its spelling for the diagnostics.
+*/
+void make_key(const char* token, struct token_key* key){
+  unsigned i;
+  char c;
+
+  memset(key->name, NUL, KEY_LEN);
+  key->length = 0;
+  key->hash = 0;
+  key->suffix = NUL;
+  for(i = 0; (c = token[i]) != NUL && c != '.'; i++){
+    if(i == KEY_LEN - 1){       // Too long, leave the key empty
+      memset(key->name, NUL, KEY_LEN);
+      return;
+    }
+    key->name[i] = (c >= 'a' && c <= 'z') ? c - ('a' - 'A') : c;
+  }
+  if(c == '.'){                 // Only one character may follow the '.'
+    c = token[i + 1];
+    key->suffix = (c == NUL || token[i + 2] != NUL) ? '?' :
+                  (c >= 'a' && c <= 'z') ? c - ('a' - 'A') : c;
+  }
+  key->length = i;
+  key->hash = hash_key(key->name);
+}
+
+/* FNV-1a over the full width of a key */
+unsigned hash_key(const char* name){
+  return hash_text(name, KEY_LEN);
+}
+
+/* FNV-1a over length chars of text */
+unsigned hash_text(const char* text, unsigned length){
+  unsigned hash = 2166136261u;
+  unsigned i;
+
+  for(i = 0; i < length; i++){
+    hash = (hash ^ (unsigned char)text[i]) * 16777619u;
+  }
+  return hash;
+}
+
+/* Prints the counters of the first pass to the terminal and diagnostics */
+void print_statistics(void){
+  unsigned hits = atomic_load(&cache_hits);
+  unsigned misses = atomic_load(&cache_misses);
+
+  printf("\n--------------    Statistics    --------------\n");
+  fprintf(fout, "\n--------------    Statistics    --------------\n");
+  printf("Line cache hits: %u \t Misses: %u\n", hits, misses);
+  fprintf(fout, "Line cache hits: %u\t\tMisses: %u\n", hits, misses);
+  printf("Records: %u \t Bytes: %zu\n", record_count(), record_bytes());
+  fprintf(fout, "Records: %u\t\tBytes: %zu\n", record_count(), record_bytes());
+}
+
 /*
   is_label checks to see if a token follows all the rules for a label to be
   considered valid. First character must be alphabetic and the following can
@@ -204,6 +511,14 @@ void analyzelabel(char* line, char* token){
 */
 
 unsigned char is_label(char* token){
+  struct token_key key;
+
+  make_key(token, &key);
+  return is_label_key(token, &key);
+}
+
+/* is_label() for a token whose key has already been made */
+unsigned char is_label_key(char* token, const struct token_key* key){
   int short i = 1;
   unsigned char res = FALSE;
 
@@ -219,14 +534,14 @@ unsigned char is_label(char* token){
       i++;
     }
 
-    if(get_inst(token)){  // Labels cannot have instruction names
+    if(get_inst_key(key)){  // Labels cannot have instruction names
       res = FALSE;
       #ifdef debug
       printf("LABEL >>%s<< HAS INSTRUCTION NAME\n", token);
       #endif /* debug */
     }
 
-    if(get_dir(token)){ // Lables cannot have directive names
+    if(get_dir_key(key)){ // Lables cannot have directive names
       res = FALSE;
       #ifdef debug
       printf("LABEL >>%s<< HAS DIRECTIVE NAME\n", token);
@@ -237,74 +552,80 @@ unsigned char is_label(char* token){
 }
 
 /*
-  As per the function's name, it returns TRUE if the characters passed to it
-  comprise a number. Returns false otherwise.
+  Parses a numeric literal at the start of text in a single pass: decimal,
+  $hex or 0x hex, each optionally negative. The value is returned in value and
+  the number of chars used, sign and prefix included, in length. Parsing stops
+  at the first char which is not a digit of the base, the caller decides what
+  may follow. Returns NUM_NONE if text does not start with a literal,
+  NUM_BAD_DIGIT for a prefix without digits and NUM_RANGE on overflow.
 */
-int is_number(char* line){
-  char* source;
-  char* token;
-  int res = EXIT_FAIL;
+enum NUM_STATUS parse_number(const char* text, int* value, unsigned* length){
+  const char* ptr = text;
+  unsigned long accum = 0;
+  unsigned base = 10;
+  unsigned digits = 0;
   unsigned char flag_negative = FALSE;
+  int digit;
 
-  if(!line){
-    return res;
+  *value = 0;
+  *length = 0;
+  if(!text){
+    return NUM_NONE;
   }
 
-  token = strtok(line, " \t\r\n");
-  #ifdef debug
-  printf("Testing if >>%s<< is a number\n", token);
-  #endif /* debug */
-
-  if(token[0] == '-'){
-    #ifdef debug
-    printf("Negative Number\n");
-    #endif /* debug */
+  if(*ptr == '-'){
     flag_negative = TRUE;
-    source = &token[1];
+    ptr++;
   }
-  else{
-    source = token;
+
+  if(*ptr == '$'){
+    base = 16;
+    ptr++;
+  }
+  else if(ptr[0] == '0' && (ptr[1] == 'x' || ptr[1] == 'X')){
+    base = 16;
+    ptr += 2;
+  }
+  else if(!isdigit(*ptr)){
+    return NUM_NONE;
   }
 
-  switch (source[0]) {
-    case '$':
-    *source++;
-    if(cyclenumber(source, HEXADECIMAL)){ //cycle through chars expecting hex
-      res = strtol(source, NULL, 16);     //return as int
+  for(;; ptr++, digits++){
+    if(*ptr >= '0' && *ptr <= '9'){
+      digit = *ptr - '0';
     }
-    break;
-    case '0':
-    if (source[1] == 'x' || source[1] == 'X') {
-      if(cyclenumber(source, HEXADECIMAL)){
-        res = strtol(source, NULL, 16);
-        break;
-      }
+    else if(base == 16 && (*ptr | 0x20) >= 'a' && (*ptr | 0x20) <= 'f'){
+      digit = (*ptr | 0x20) - 'a' + 10;
     }
-    case '1':
-    case '2':
-    case '3':
-    case '4':
-    case '5':
-    case '6':
-    case '7':
-    case '8':
-    case '9':
-    if(cyclenumber(source, DECIMAL)){ //cycle through chars expecting decimal
-      res = strtol(source, NULL, 10); //return as int
+    else{
+      break;
+    }
+    if((accum = accum*base + digit) > MAX_LITERAL){
+      return NUM_RANGE;
     }
-    break;
-    default:
-    #ifdef debug
-    printf("%c not a valid number\n", source[0]);
-    #endif
-    break;
   }
 
-  if(flag_negative && res != EXIT_FAIL){
-    res = -res;         // return the number as a negative
+  if(digits == 0){
+    return NUM_BAD_DIGIT;
   }
-  printf("is_number returning %d\n", res);
-  return res;
+  *value = flag_negative ? -(int)accum : (int)accum;
+  *length = ptr - text;
+  return NUM_OK;
+}
+
+/*
+  Parses a token made of a single literal. Anything but whitespace following
+  the literal makes it a NUM_BAD_DIGIT.
+*/
+enum NUM_STATUS parse_literal(const char* token, int* value){
+  enum NUM_STATUS status;
+  unsigned length;
+
+  status = parse_number(token, value, &length);
+  if(status == NUM_OK && token[length] != NUL && !isspace(token[length])){
+    status = NUM_BAD_DIGIT;
+  }
+  return status;
 }
 
 /*
@@ -323,53 +644,6 @@ char* storeline(char* line){
     string[i] = line[i];
     i++;
   }
+  string[i] = NUL;
   return string;
 }
-
-/*
-  As per the function name it simply cycles through the chars of an array to
-  check whether the array is indeed a number, be it hex or decimal.
-*/
-int cyclenumber(char* number, int type){
-  unsigned short i = 0;
-  unsigned short res = TRUE;
-  unsigned short length;
-
-  switch (type) {
-    case HEXADECIMAL:
-    #ifdef debug
-    printf("Checking for HEX\n");
-    #endif /* debug */
-    number += 2;
-    length = strlen(number);
-    while(i < length){
-      if(!(((number[i] >= '0') && (number[i] <= '9')) ||
-         ((number[i] >= 'a') && (number[i] <= 'f')) ||
-         ((number[i] >= 'A') && (number[i] <= 'F')))) {
-        #ifdef debug
-        printf("%s is not a HEX\n", number);
-        #endif /* debug */
-        return res = FALSE;
-      }
-      i++;
-    }
-    break;
-
-    case DECIMAL:
-    #ifdef debug
-    printf("Checking for DECIMAL\n");
-    #endif /* debug */
-    length = strlen(number);
-    while (i < length){
-      if(!isdigit(number[i])){
-        #ifdef debug
-        printf("%s is not a DECIMAL\n", number);
-        #endif /* debug */
-        return res = FALSE;
-      }
-      i++;
-    }
-    break;
-  }
-  return res;
-}
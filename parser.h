@@ -7,42 +7,96 @@
 
   Coder: Elias Vonapartis
   Release Date: May 28, 2016
-  Latest Updates: None
+  Latest Updates: Oct 19, 2026  - parse_number() replaces is_number()
+                                - Added the case folded token keys
+                                - Added the parallel classification step
+                                - Added the line classification cache
+                                - Label of the starting address kept
 */
 
+#include "assembler.h"
+
 #define LINE_LEN      256
 #define NUL           '\0'
 #define TRUE          1
 #define FALSE         0
-#define EXIT_FAIL  70000
-#define HEXADECIMAL   1
-#define DECIMAL       0
+#define MAX_LITERAL   0x7FFFFFFF
+#define KEY_LEN       8       // Longest mnemonic or directive plus padding
+#define PARALLEL_MIN_LINES  2048  // Fewer lines per thread are not worth it
+#define LINE_CACHE_SLOTS    256   // Direct mapped, must be a power of 2
 
 extern FILE* fout;
 
 unsigned char flag_end_of_program;
 unsigned char flag_first_token_label;
 unsigned short start_address;
+unsigned start_symbol;        // Label of the starting address, see end()
 
 char* global;
 unsigned int line_number;
 
 enum TOKENTYPE {LABEL, INST, DIR, OP, COMMENT, UNKNOWN};
+enum NUM_STATUS {NUM_OK, NUM_NONE, NUM_BAD_DIGIT, NUM_RANGE};
+
+struct line_scan;
+struct line_info;
+
+/*
+  Upper case, NUL padded copy of a token used to probe the instruction and
+  directive tables. length is 0 when the token is too long to be either. Any
+  '.' suffix is split off into suffix, '?' if it is not a single character.
+*/
+struct token_key{
+  char name[KEY_LEN];
+  unsigned hash;
+  unsigned char length;
+  char suffix;
+};
+
+/*
+  Recently classified instruction lines of one parallel range, keyed by the
+  text after any label with the comment and trailing blanks cut off. The text
+  is the line's own within the source buffer, so it is never copied.
+*/
+struct line_cache_entry{
+  const char* text;                 // NULL while the slot is empty
+  unsigned short length;
+  unsigned hash;
+  struct line_info* line;           // Line classified from this text
+  unsigned short operands_len;      // Size of its operand field copy
+};
+
+struct line_cache{
+  struct line_cache_entry slot[LINE_CACHE_SLOTS];
+  unsigned hits;
+  unsigned misses;
+};
 
 struct firsttoken{
   enum TOKENTYPE type;
   struct dir_el *dirptr;
   struct inst_el *instptr;
+  enum BYTE_COMB bw;                // Operation size from the suffix
 };
 
 /* Function Declarations */
 void firstpass(FILE* );
+void copy_line(struct line_info* , char* );
+void classify_lines(unsigned , unsigned , void* );
+void classify_line(struct line_info* , struct line_cache* );
+unsigned hash_text(const char* , unsigned );
+void print_statistics(void);
+void commit_line(struct line_info* );
+char* readsource(FILE* , size_t* );
 void parse_record(char* );
 struct firsttoken sort(char *);
-void analyzelabel(char* , char* );
+void analyzelabel(struct line_scan* , unsigned , char* );
+void make_key(const char* , struct token_key* );
+unsigned hash_key(const char* );
 unsigned char is_label(char* );
-int is_number(char* );
+unsigned char is_label_key(char* , const struct token_key* );
+enum NUM_STATUS parse_number(const char* , int* , unsigned* );
+enum NUM_STATUS parse_literal(const char* , int* );
 char* storeline(char* );
-int cyclenumber(char* , int );
 
 #endif /* PARSER_H */
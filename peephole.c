@@ -0,0 +1,299 @@
+/*
+  peephole.c
+  Optional pass over the first pass records, run once every label is known and
+  before the jumps are relaxed. It looks at short runs of instructions and
+  rewrites them into smaller and faster ones doing the same:
+      MOV #n,&X  MOV #n,R5      MOV #n,R5  MOV R5,&X
+      MOV #n,R5 ... MOV #n,R5   the second load is removed
+      ADD #-4,R5                SUB #4,R5, and SUB #-4 into ADD #4
+  The code shrinks, so the records and labels after it are moved down the way
+  relaxation moves them up.
+
+  Coder: Elias Vonapartis
+  Release Date: Oct 19, 2026
+  Latest Updates: None
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "assembler.h"
+#include "parser.h"
+#include "instructions.h"
+#include "symboltable.h"
+#include "records.h"
+#include "secondpass.h"
+#include "peephole.h"
+
+/* Size in bytes of an instruction record with its operands as they are now */
+static unsigned inst_bytes(struct inst_record* inst){
+  unsigned count = inst->tag.kind == REC_DOUBLE ? 2 :
+                   inst->tag.kind == REC_SINGLE;
+  unsigned bytes = WORDINC;
+  unsigned k;
+
+  for(k = 0; k < count; k++){
+    bytes += WORDINC * mode_desc_of(inst->op[k].mode, inst->op[k].constgen,
+                                    inst->op[k].value)->ext_words;
+  }
+  return bytes;
+}
+
+/* TRUE if the record is a double operand instruction of the given name */
+static unsigned char is_double(struct record_tag* tag, const char* name){
+  return tag->kind == REC_DOUBLE &&
+         strcmp(inst_list[((struct inst_record*)tag)->inst].inst, name) == 0;
+}
+
+/* TRUE if the record is MOV #n,Rn into one of R4 to R15 */
+static unsigned char is_load(struct record_tag* tag){
+  struct inst_record* inst = (struct inst_record*)tag;
+
+  return is_double(tag, "MOV") && inst->op[0].mode == IMMEDIATE &&
+         inst->op[1].mode == REGISTER && inst->op[1].reg >= FIRST_GP_REG;
+}
+
+/* TRUE if both operands are the same immediate, label included */
+static unsigned char same_immediate(const struct record_operand* a,
+                                    const struct record_operand* b){
+  return a->mode == IMMEDIATE && b->mode == IMMEDIATE &&
+         a->value == b->value && a->symbol == b->symbol;
+}
+
+/*
+  Marks the records a label is anchored to. Code can be jumped to there, so no
+  rewrite may rely on what ran before one.
+*/
+static unsigned char* label_marks(unsigned count){
+  unsigned char* labeled = calloc(count + 1, sizeof(*labeled));
+  struct symbol_entry* stptr;
+  unsigned limit = symbol_limit();
+  unsigned id;
+
+  for(id = REG_COUNT + REG_ALIASES; id < limit; id++){
+    if((stptr = symbol_by_id(id)) && stptr->type == LBLTYPE &&
+       stptr->anchor < count){
+      labeled[stptr->anchor] = TRUE;
+    }
+  }
+  return labeled;
+}
+
+/* Index of the first record after i which was not removed, count if none */
+static unsigned next_live(struct peep_pass* pass, unsigned i){
+  while(++i < pass->count && pass->tags[i]->kind == REC_REMOVED);
+  return i;
+}
+
+/* Keeps how much record i changed size from before bytes */
+static void resized(struct peep_pass* pass, unsigned i, unsigned before){
+  pass->growth[i] += (int)inst_bytes((struct inst_record*)pass->tags[i]) -
+                     (int)before;
+}
+
+/* Counts a rewrite and ends its line in the listing */
+static void saved(struct peep_pass* pass, unsigned bytes, unsigned cycles){
+  fprintf(fout, ", %u bytes %u cycles saved\n", bytes, cycles);
+  pass->rewrites++;
+  pass->bytes += bytes;
+  pass->cycles += cycles;
+}
+
+/*
+  TRUE if the record may change reg or leave the straight line of code, which
+  ends the search for a reload of reg: anything but an instruction with
+  operands, a CALL, a write to reg or to PC, or stepping reg with @Rn+. Single
+  operand instructions are taken to write their operand.
+*/
+static unsigned char changes_reg(struct record_tag* tag, signed char reg){
+  struct inst_record* inst = (struct inst_record*)tag;
+  struct record_operand* op;
+  unsigned k;
+
+  if(tag->kind == REC_SINGLE){
+    op = &inst->op[0];
+    return strcmp(inst_list[inst->inst].inst, "CALL") == 0 ||
+           ((op->mode == REGISTER || op->mode == INDIRECT_INCR) &&
+            (op->reg == reg || op->reg == PC_REG));
+  }
+  if(tag->kind != REC_DOUBLE){
+    return TRUE;
+  }
+  for(k = 0; k < 2; k++){
+    op = &inst->op[k];
+    if(op->mode == INDIRECT_INCR && op->reg == reg){
+      return TRUE;
+    }
+  }
+  op = &inst->op[1];
+  return op->mode == REGISTER && (op->reg == reg || op->reg == PC_REG);
+}
+
+/*
+  MOV #n,dst followed by MOV #n,Rn, with dst in memory, becomes MOV #n,Rn then
+  MOV Rn,dst. The store loses its immediate, a word and the cycle to fetch it.
+  The load must not have a label, as code jumping there would store an Rn it
+  has not loaded, and dst must not be indexed by Rn.
+*/
+static void store_from_reload(struct peep_pass* pass, unsigned i){
+  struct inst_record* store = (struct inst_record*)pass->tags[i];
+  struct inst_record* load;
+  struct record_operand dst;
+  unsigned before_store;
+  unsigned before_load;
+  unsigned j = next_live(pass, i);
+
+  if(j == pass->count || pass->labeled[j] || !is_double(pass->tags[i], "MOV")
+     || !is_load(pass->tags[j])){
+    return;
+  }
+  load = (struct inst_record*)pass->tags[j];
+  dst = store->op[1];
+  if(store->bw != load->bw || store->op[0].constgen ||
+     !same_immediate(&store->op[0], &load->op[0]) ||
+     (dst.mode != ABSOLUTE && dst.mode != RELATIVE && dst.mode != INDEXED) ||
+     (dst.mode == INDEXED && (dst.reg == load->op[1].reg ||
+                              dst.reg == PC_REG))){
+    return;
+  }
+
+  before_store = inst_bytes(store);
+  before_load = inst_bytes(load);
+  store->op[1] = load->op[1];
+  load->op[0] = load->op[1];
+  load->op[1] = dst;
+  resized(pass, i, before_store);
+  resized(pass, j, before_load);
+
+  fprintf(fout, "Line %d: MOV #%04x stored then loaded into R%d, now stored "
+          "from R%d", pass->tags[i]->line, store->op[0].value & 0xFFFF,
+          store->op[1].reg, store->op[1].reg);
+  saved(pass, before_store + before_load - inst_bytes(store) -
+        inst_bytes(load), EXT_CYCLES);
+}
+
+/*
+  ADD #v and SUB #v add the same 17 bit sum, carry included, as SUB #-v and
+  ADD #-v, so the flags are the same either way. When -v is a constant
+  generator value the immediate and the cycle to fetch it are saved. ADDC and
+  SUBC differ by the carry and are left alone, as are immediates of a label
+  which can still move and ADD #v,PC, which depends on its own size.
+*/
+static void negate_immediate(struct peep_pass* pass, unsigned i){
+  struct inst_record* inst = (struct inst_record*)pass->tags[i];
+  struct record_operand* src = &inst->op[0];
+  struct symbol_entry* stptr;
+  const char* other;
+  int mask = inst->bw == BYTE ? 0xFF : 0xFFFF;
+  int negated;
+  unsigned before;
+
+  if(is_double(pass->tags[i], "ADD")){
+    other = "SUB";
+  }
+  else if(is_double(pass->tags[i], "SUB")){
+    other = "ADD";
+  }
+  else{
+    return;
+  }
+  if(src->mode != IMMEDIATE || src->constgen ||
+     (inst->op[1].mode == REGISTER && inst->op[1].reg == PC_REG) ||
+     (src->symbol != NO_SYMBOL && (stptr = symbol_by_id(src->symbol)) &&
+      stptr->type == LBLTYPE && stptr->anchor != NO_RECORD)){
+    return;
+  }
+  negated = -src->value & mask;
+  if(negated == 0 || !CONGEN(negated)){
+    return;
+  }
+
+  fprintf(fout, "Line %d: %s #%04x now %s #%d", pass->tags[i]->line,
+          inst_list[inst->inst].inst, src->value & mask, other, negated);
+  before = inst_bytes(inst);
+  inst->inst = get_inst((char* )other) - inst_list;
+  src->value = negated;
+  src->symbol = NO_SYMBOL;
+  src->constgen = TRUE;
+  resized(pass, i, before);
+  saved(pass, before - inst_bytes(inst), EXT_CYCLES);
+}
+
+/*
+  Once MOV #n,Rn has run, a later MOV #n,Rn of the same size is removed, as
+  long as nothing in between changes Rn or can be jumped to, see changes_reg().
+  The next PEEP_WINDOW instructions are searched. A load into a register takes
+  a cycle for each of its words, so that is what each removal saves.
+*/
+static void drop_reloads(struct peep_pass* pass, unsigned i){
+  struct inst_record* load = (struct inst_record*)pass->tags[i];
+  struct inst_record* inst;
+  signed char reg = load->op[1].reg;
+  unsigned bytes;
+  unsigned j = i;
+  unsigned n;
+
+  if(!is_load(pass->tags[i])){
+    return;
+  }
+  for(n = 0; n < PEEP_WINDOW && (j = next_live(pass, j)) < pass->count &&
+             !pass->labeled[j]; n++){
+    inst = (struct inst_record*)pass->tags[j];
+    if(is_load(pass->tags[j]) && inst->op[1].reg == reg &&
+       inst->bw == load->bw && same_immediate(&inst->op[0], &load->op[0])){
+      bytes = inst_bytes(inst);
+      pass->tags[j]->kind = REC_REMOVED;
+      pass->growth[j] -= bytes;
+      fprintf(fout, "Line %d: MOV #%04x,R%d removed, R%d holds it since line "
+              "%d", pass->tags[j]->line, inst->op[0].value & 0xFFFF, reg, reg,
+              pass->tags[i]->line);
+      saved(pass, bytes, bytes / WORDINC);
+    }
+    else if(changes_reg(pass->tags[j], reg)){
+      return;
+    }
+  }
+}
+
+/*
+  Peephole optimization of the instruction records. Each instruction is tried
+  as the start of every rewrite, in order, then the records and labels are
+  moved down by what was saved before them. Every rewrite is listed. Returns
+  FALSE if the result could not be laid out.
+*/
+unsigned char peephole(void){
+  struct peep_pass pass;
+  unsigned char res;
+  unsigned i;
+  int* shift;
+
+  pass.count = record_count();
+  pass.tags = record_table();
+  pass.labeled = label_marks(pass.count);
+  pass.growth = calloc(pass.count + 1, sizeof(*pass.growth));
+  pass.rewrites = 0;
+  pass.bytes = 0;
+  pass.cycles = 0;
+  shift = malloc((pass.count + 1) * sizeof(*shift));
+
+  fprintf(fout, "\n--------------    Peephole Optimizer    --------------\n");
+  for(i = 0; i < pass.count; i++){
+    if(pass.tags[i]->kind == REC_REMOVED){
+      continue;
+    }
+    store_from_reload(&pass, i);
+    negate_immediate(&pass, i);
+    drop_reloads(&pass, i);
+  }
+
+  layout_shifts(pass.tags, pass.count, pass.growth, shift);
+  res = move_symbols(pass.tags, pass.count, shift);
+  fprintf(fout, "Rewrites: %u\t\tBytes saved: %u\t\tCycles saved: %u\n",
+          pass.rewrites, pass.bytes, pass.cycles);
+
+  free(pass.tags);
+  free(pass.labeled);
+  free(pass.growth);
+  free(shift);
+  return res;
+}
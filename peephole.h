@@ -0,0 +1,34 @@
+#ifndef PEEPHOLE_H
+#define PEEPHOLE_H
+
+/*
+  peephole.h
+  Header file for peephole.c
+
+  Coder: Elias Vonapartis
+  Release Date: Oct 19, 2026
+  Latest Updates: None
+*/
+
+#include "records.h"
+
+#define PEEP_WINDOW   16        // Records searched for a reload of a register
+#define FIRST_GP_REG  4         // R4 to R15 are free for the program to use
+#define EXT_CYCLES    1         // An extension word takes a cycle to fetch
+
+/* Where the pass is in the record table, and what it has saved so far */
+struct peep_pass{
+  struct record_tag** tags;
+  unsigned count;
+  unsigned char* labeled;       // TRUE where a label is anchored
+  int* growth;                  // Bytes each record has grown by, see
+                                // layout_shifts(), negative as they shrink
+  unsigned rewrites;
+  unsigned bytes;
+  unsigned cycles;
+};
+
+/* Function Declarations */
+unsigned char peephole(void);
+
+#endif /* PEEPHOLE_H */
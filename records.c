@@ -6,143 +6,366 @@
   Coder: Elias Vonapartis
   Release Date: May 28, 2016
   Latest Updates: June 8, 2016  - Added jump forward reference support
+                  Oct 19, 2026  - Records hold the classified operands
+                                - Forward jumps keep the ID of their target
+                                - Symbol values patched in by fixups
+                                - Compact records in one growable buffer
+                                - Layout of the optional passes moved here
 */
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "records.h"
 #include "symboltable.h"
+#include "errors.h"
 
-struct record_entry* new_entry(char* inst, enum INST_TYPE type, char* src_op,
-            char* dst_op, enum ADDR_MODE src_mode, enum ADDR_MODE dst_mode,
-            unsigned short offset, char* string, int value, unsigned char wbosb){
-
-  struct record_entry* newentry;
-  newentry = malloc(sizeof(struct record_entry));
-
-  newentry->line = line_number;
-  newentry->LC = LC;
-  newentry->inst = inst;
-  newentry->type = type;
-  newentry->src_op = src_op;
-  newentry->dst_op = dst_op;
-  newentry->src_mode = src_mode;
-  newentry->dst_mode = dst_mode;
-  newentry->offset = offset;
-  newentry->string = string;
-  newentry->value = value;
-  newentry->wbosb = wbosb;
+/*
+  The records of the first pass, one after the other. Records are named by
+  their offset in the buffer as it moves when it grows.
+*/
+static unsigned char* record_buf = NULL;
+static size_t record_used = 0;
+static size_t record_size = 0;
+static unsigned records = 0;
 
-  newentry->prev = NULL;
-  newentry->next = NULL;
-  return newentry;
-}
+#define record_at(offset) ((struct record_tag*)(record_buf + (offset)))
 
 /*
-  This function creates a new node to add to the linked-list. All data needed
-  for the entry is passed through newentry.
+  Reserves a record of kind with bytes of tag and payload at the end of the
+  buffer and fills in the tag. Returns the offset of the record.
 */
-void double_linking(struct record_entry* newentry, struct record_entry* temp){
-  if(head == NULL){
-    head = newentry;
-    return;
-  }
-  while(temp->next !=NULL){
-    temp = temp->next;
+unsigned new_record(enum RECORD_KIND kind, size_t bytes){
+  struct record_tag* tag;
+  unsigned offset = record_used;
+
+  bytes = (bytes + RECORD_ALIGN - 1) & ~(size_t)(RECORD_ALIGN - 1);
+  if(record_used + bytes > record_size){
+    record_size = record_size ? record_size * 2 : RECORD_BUF_INIT;
+    record_buf = realloc(record_buf, record_size);
   }
-  temp->next = newentry;
-  newentry->prev = temp;
+  record_used += bytes;
+  records++;
+
+  tag = record_at(offset);
+  memset(tag, 0, bytes);
+  tag->line = line_number;
+  tag->LC = LC;
+  tag->kind = kind;
+  tag->size = bytes / RECORD_ALIGN;
+  return offset;
+}
+
+/* Keeps what the second pass needs of an operand */
+void store_operand(struct record_operand* rop, struct operand* op){
+  rop->value = op->value;
+  rop->symbol = op->symbol;
+  rop->mode = op->mode;
+  rop->reg = op->reg;
+  rop->constgen = op->constgen;
 }
 
 /*
   The following add_x_record functions are different renditions of the same code.
   They take the arguments needed for their respective x variables. Repeated code
-  for clarity reasons in the first pass code of the assembler.
+  for clarity reasons in the first pass code of the assembler. The kind of an
+  instruction record is the type of its instruction, with as many operands.
 */
-void add_inst_record(char* inst, enum INST_TYPE type, char* src_op, char* dst_op,
-                     enum ADDR_MODE src_mode, enum ADDR_MODE dst_mode){
-   struct record_entry* temp = head;
-   struct record_entry* newentry;
-   newentry = new_entry(inst, type, src_op, dst_op, src_mode, dst_mode, -1,
-                        NULL, -1, -1);
-   double_linking(newentry, temp);
-}
-
-void add_jump_record(char* inst, enum INST_TYPE type, char* offset){
-  struct record_entry* temp = head;
-  struct record_entry* newentry;
+unsigned add_inst_record(struct inst_el* instptr, enum BYTE_COMB bw,
+                         struct operand* src, struct operand* dst){
+  static const enum RECORD_KIND kinds[] = {
+    [NONE] = REC_NONE, [SINGLE] = REC_SINGLE, [DOUBLE] = REC_DOUBLE
+  };
+  struct inst_record* rec;
+  unsigned count = (src != NULL) + (dst != NULL);
+  unsigned offset;
+
+  offset = new_record(kinds[instptr->type], sizeof(struct inst_record) +
+                      count * sizeof(struct record_operand));
+  rec = (struct inst_record*)record_at(offset);
+  rec->inst = instptr - inst_list;
+  rec->bw = bw;
+  if(src){
+    store_operand(&rec->op[0], src);
+  }
+  if(dst){
+    store_operand(&rec->op[1], dst);
+  }
+  return offset;
+}
+
+void add_jump_record(struct inst_el* instptr, char* target){
+  struct jump_record* rec;
   struct symbol_entry* tmp;
-  short off;
+  unsigned offset;
+  int value = 0;
 
-  (tmp = get_entry(offset)) ? (off = tmp->value) : (off = is_number(offset));
+  if(!(tmp = get_entry(target))){
+    parse_literal(target, &value);    // checkjump() has validated it
+  }
 
-  if(tmp){
-    if(tmp->type == UNKTYPE){
-      newentry = new_entry(inst, type, offset, NULL, -1, -1, off, NULL, -1, -1);
-    }
-    else{
-      newentry = new_entry(inst, type, NULL, NULL, -1, -1, off, NULL, -1, -1);
-    }
+  offset = new_record(REC_JUMP, sizeof(struct jump_record));
+  rec = (struct jump_record*)record_at(offset);
+  rec->inst = instptr - inst_list;
+  rec->offset = value;
+  rec->symbol = tmp ? tmp->id : NO_SYMBOL;
+  if(tmp){                            // Patched now or once it is defined
+    add_fixup(tmp->id, offset, FIX_JUMP);
   }
-  else{
-    newentry = new_entry(inst, type, NULL, NULL, -1, -1, off, NULL, -1, -1);
+}
+
+/* Gives the field of the record at offset the value of the symbol it uses */
+void apply_fixup(unsigned offset, enum FIXUP_KIND kind, int value){
+  struct record_tag* tag = record_at(offset);
+
+  switch (kind) {
+    case FIX_SRC:
+    ((struct inst_record*)tag)->op[0].value = value;
+    break;
+    case FIX_DST:
+    ((struct inst_record*)tag)->op[1].value = value;
+    break;
+    case FIX_JUMP:
+    ((struct jump_record*)tag)->offset = value;
+    break;
   }
-  double_linking(newentry, temp);
 }
 
+/* The string is copied into the record, NUL included */
 void add_string_record(char* string, unsigned short length){
-  struct record_entry* temp = head;
-  struct record_entry* newentry;
-  newentry=new_entry(NULL, -1, NULL, NULL, -1, -1, -1, string, -1, STRING2);
-  double_linking(newentry, temp);
+  struct string_record* rec;
+  unsigned offset;
+
+  offset = new_record(REC_STRING, sizeof(struct string_record) + length + 1);
+  rec = (struct string_record*)record_at(offset);
+  rec->length = length;
+  memcpy(rec->text, string, length);
+  rec->text[length] = NUL;
+}
+
+void add_value_record(enum RECORD_KIND kind, int value){
+  unsigned offset = new_record(kind, sizeof(struct data_record));
+  ((struct data_record*)record_at(offset))->value = value;
 }
 
 void add_data_record(int number, unsigned char BW){
-  struct record_entry* temp = head;
-  struct record_entry* newentry;
-  newentry=new_entry(NULL, -1, NULL, NULL, -1, -1, -1, NULL, number, BW);
-  double_linking(newentry, temp);
+  add_value_record(BW == BYTE2 ? REC_BYTE : REC_WORD, number);
 }
 
 void add_org_record(unsigned short address){
-  struct record_entry* temp = head;
-  struct record_entry* newentry;
-  newentry=new_entry(NULL, -1, NULL, NULL, -1, -1, -1, NULL, address, ORG2);
-  double_linking(newentry, temp);
+  add_value_record(REC_ORG, address);
 }
 
 void add_bss_record(unsigned short addresses){
-  struct record_entry* temp = head;
-  struct record_entry* newentry;
-  newentry=new_entry(NULL, -1, NULL, NULL, -1, -1, -1, NULL, addresses, BSS2);
-  double_linking(newentry, temp);
+  add_value_record(REC_BSS, addresses);
+}
+
+/* Returns the first record, or NULL if there are none */
+struct record_tag* first_record(void){
+  return record_used ? record_at(0) : NULL;
 }
+
+/* Returns the record following tag, or NULL at the end */
+struct record_tag* next_record(struct record_tag* tag){
+  unsigned char* next = (unsigned char*)tag + tag->size * RECORD_ALIGN;
+  return next < record_buf + record_used ? (struct record_tag*)next : NULL;
+}
+
+unsigned record_count(void){
+  return records;
+}
+
+size_t record_bytes(void){
+  return record_used;
+}
+
 /*
   Prints part of the structures' members for debugging purposes.
 */
 void print_records(void){
-  struct record_entry* temp = head;
+  struct record_tag* tag = first_record();
+  struct inst_record* inst;
+  struct jump_record* jump;
 
-  if(temp == NULL){
+  if(tag == NULL){
     printf("The record table is empty\n");
     return;
   }
 
-	while(temp != NULL) {
-    printf("Record: %d \tLC: %d \tINST: %s \tType: %d\n\t\tSRC: %s \tDST: %s "
-    "\tSRCMODE: %d\t DSTMODE: %d \tOffset: %d\n",
-    temp->line, temp->LC, temp->inst, temp->type, temp->src_op, temp->dst_op,
-    temp->src_mode, temp->dst_mode, temp->offset);
-		temp = temp->next;
-	}
+  while(tag != NULL) {
+    printf("Record: %d \tLC: %d \tKind: %d", tag->line, tag->LC, tag->kind);
+    switch (tag->kind) {
+      case REC_SINGLE:
+      case REC_DOUBLE:
+      inst = (struct inst_record*)tag;
+      printf(" \tINST: %s \tSRC: %s \tSRCMODE: %d", inst_list[inst->inst].inst,
+             symbol_name(inst->op[0].symbol), inst->op[0].mode);
+      if(tag->kind == REC_DOUBLE){
+        printf(" \tDST: %s \tDSTMODE: %d", symbol_name(inst->op[1].symbol),
+               inst->op[1].mode);
+      }
+      break;
+      case REC_NONE:
+      printf(" \tINST: %s", inst_list[((struct inst_record*)tag)->inst].inst);
+      break;
+      case REC_JUMP:
+      jump = (struct jump_record*)tag;
+      printf(" \tINST: %s \tTarget: %s \tOffset: %d", inst_list[jump->inst].inst,
+             symbol_name(jump->symbol), jump->offset);
+      break;
+      case REC_STRING:
+      printf(" \tString: %s", ((struct string_record*)tag)->text);
+      break;
+      case REC_REMOVED:
+      printf(" \tRemoved");
+      break;
+      default:
+      printf(" \tValue: %d", ((struct data_record*)tag)->value);
+      break;
+    }
+    printf("\n");
+    tag = next_record(tag);
+  }
 }
 
 /* This function clears the whole record table */
 void clear_records(void){
-  struct record_entry *oldentry = head;
-  while(oldentry){
-    free(oldentry);
-    head = head->next;
-    oldentry = head;     // Update to the next existing node
+  free(record_buf);
+  record_buf = NULL;
+  record_used = 0;
+  record_size = 0;
+  records = 0;
+}
+
+/*
+  Returns every record in order, with one more slot for the optional passes to
+  use as the end. The caller frees the table.
+*/
+struct record_tag** record_table(void){
+  struct record_tag** tags = malloc((records + 1) * sizeof(*tags));
+  struct record_tag* tag;
+  unsigned i = 0;
+
+  for(tag = first_record(); tag; tag = next_record(tag)){
+    tags[i++] = tag;
+  }
+  tags[i] = NULL;
+  return tags;
+}
+
+/*
+  Fills in shift[i], how far record i moves once every record before it has
+  grown by growth[] bytes, less if it shrinks. An ORG starts the LCs over, so
+  the shift only builds up from one ORG to the next. shift[count] is that of a
+  label after the last record.
+*/
+void layout_shifts(struct record_tag** tags, unsigned count, const int* growth,
+                   int* shift){
+  int run = 0;
+  unsigned i;
+
+  for(i = 0; i < count; i++){
+    shift[i] = run;
+    run = tags[i]->kind == REC_ORG ? 0 : run + growth[i];
+  }
+  shift[count] = run;
+}
+
+/* Gives an operand the value its symbol has now */
+static unsigned char move_operand(struct record_operand* op){
+  struct symbol_entry* stptr;
+
+  if(op->symbol == NO_SYMBOL || !(stptr = symbol_by_id(op->symbol)) ||
+     stptr->type != LBLTYPE){
+    return TRUE;
+  }
+  op->value = stptr->value;
+  if(op->constgen && !CONGEN(op->value)){
+    error_count("ERROR: The layout moved a constant generator label:",
+                stptr->name);
+    return FALSE;
+  }
+  return TRUE;
+}
+
+/*
+  Checks that the section ending at the ORG record org, which started at start
+  and grows by shift, still ends at or before the address of the ORG when that
+  comes after it. The LC of an ORG record is where the section before it ended.
+  Returns FALSE, with an error, if the section now runs into the next one.
+*/
+static unsigned char section_fits(struct record_tag* org, int shift,
+                                  unsigned start){
+  unsigned short next = ((struct data_record*)org)->value;
+  char address[ADDRESS_TEXT];
+
+  if(shift > 0 && next >= start && org->LC + shift > next){
+    sprintf(address, "%04x", next);
+    error_count("ERROR: Moved code runs into the ORG at", address);
+    return FALSE;
+  }
+  return TRUE;
+}
+
+/*
+  Moves the records and the labels anchored to them by shift, then gives every
+  use of a label its new value. A section may not grow into the next ORG. Returns FALSE if something could not be moved.
+*/
+unsigned char move_symbols(struct record_tag** tags, unsigned count,
+                           const int* shift){
+  struct symbol_entry* stptr;
+  struct inst_record* inst;
+  struct jump_record* jump;
+  unsigned char res = TRUE;
+  unsigned limit = symbol_limit();
+  unsigned start = 0;
+  unsigned id;
+  unsigned i;
+
+  for(id = REG_COUNT + REG_ALIASES; id < limit; id++){
+    if((stptr = symbol_by_id(id)) && stptr->type == LBLTYPE &&
+       stptr->anchor != NO_RECORD && shift[stptr->anchor]){
+      fprintf(fout, "Label %s moved from %04x to %04x\n", stptr->name,
+              stptr->value, stptr->value + shift[stptr->anchor]);
+      stptr->value += shift[stptr->anchor];
+    }
+  }
+  if(start_symbol != NO_SYMBOL){
+    start_address = symbol_by_id(start_symbol)->value;
+  }
+
+  for(i = 0; i < count; i++){
+    if(tags[i]->kind == REC_ORG){
+      if(!section_fits(tags[i], shift[i], start)){
+        return FALSE;
+      }
+      start = ((struct data_record*)tags[i])->value;
+    }
+    else{
+      if(tags[i]->LC + shift[i] > MAX_LC){
+        error_count("ERROR: Moved code goes past the end of memory.", NULL);
+        return FALSE;
+      }
+      tags[i]->LC += shift[i];
+    }
+    switch (tags[i]->kind) {
+      case REC_DOUBLE:
+      inst = (struct inst_record*)tags[i];
+      res &= move_operand(&inst->op[1]);
+      case REC_SINGLE:
+      inst = (struct inst_record*)tags[i];
+      res &= move_operand(&inst->op[0]);
+      break;
+      case REC_JUMP:
+      jump = (struct jump_record*)tags[i];
+      if(jump->symbol != NO_SYMBOL &&
+         (stptr = symbol_by_id(jump->symbol)) && stptr->type == LBLTYPE){
+        jump->offset = stptr->value;
+      }
+      break;
+      default:
+      break;
+    }
   }
+  return res;
 }
@@ -3,16 +3,24 @@
 
 /*
   records.h
-  Header file for records.c. Contains the structure for the double-linked list
-  containing all the required information for the second pass code generation.
+  Header file for records.c. Contains the layout of the records holding all the
+  required information for the second pass code generation.
 
   Coder: Elias Vonapartis
   Release Date: May 28, 2016
-  Latest Updates: None
+  Latest Updates: Oct 19, 2026  - Operands are stored classified
+                                - Symbols are stored by ID
+                                - Symbol values patched in by fixups
+                                - Compact records in one buffer replace the
+                                  double-linked list
+                                - Jumps can be relaxed to a long form
+                                - Records can be removed by the peephole pass
 */
 
 #include "assembler.h"
 #include "parser.h"
+#include "instructions.h"
+#include "symboltable.h"
 
 #define ORG2    0
 #define BYTE2   1
@@ -20,43 +28,83 @@
 #define STRING2 3
 #define BSS2    4
 
-struct record_entry *head;
+#define RECORD_ALIGN    4         // Every record starts on this boundary
+#define RECORD_BUF_INIT 4096      // Initial size of the record buffer
+#define ADDRESS_TEXT    8         // An address in hex for a message
 
-struct record_entry{
-  /* Common for all instructions */
+/* A record removed by an optional pass keeps its place but has no code */
+enum RECORD_KIND {REC_NONE, REC_SINGLE, REC_DOUBLE, REC_JUMP, REC_WORD,
+                  REC_BYTE, REC_ORG, REC_STRING, REC_BSS, REC_REMOVED};
+
+/*
+  The records are stored one after the other in a single buffer. Each starts
+  with a tag, followed by the payload of its kind. A record is named by its
+  offset in the buffer, which stays valid as the buffer grows.
+*/
+struct record_tag{
   unsigned int line;
-  unsigned int LC;
-  char* inst;
-  enum INST_TYPE type;
+  unsigned short LC;
+  unsigned char kind;
+  unsigned char size;           // In RECORD_ALIGN units, tag included
+};
+
+/* What the second pass needs of an operand */
+struct record_operand{
+  int value;                    // Symbol values are patched in, see fixups
+  unsigned symbol;              // Symbol ID or NO_SYMBOL, for listings
+  unsigned char mode;
+  signed char reg;
+  unsigned char constgen;
+};
 
-  /* Operand Instructions */
-  char* src_op;
-  char* dst_op;
-  enum ADDR_MODE src_mode;
-  enum ADDR_MODE dst_mode;
+/* REC_NONE, REC_SINGLE and REC_DOUBLE, with as many operands as the type */
+struct inst_record{
+  struct record_tag tag;
+  unsigned char inst;           // Index in inst_list
+  unsigned char bw;
+  struct record_operand op[];   // Source then destination
+};
 
-  /* Jump Instructions */
-  unsigned short offset;
+/* Forms a jump can be assembled in, see relax_jumps() */
+enum JUMP_FORM {JUMP_SHORT, JUMP_LONG};
 
-  /* Storing for ASCII, WORD, BYTE, ORG, BSS */
-  char* string;
+struct jump_record{
+  struct record_tag tag;
+  unsigned char inst;
+  unsigned char form;           // JUMP_FORM
+  unsigned short offset;        // Target address, labels patched in
+  unsigned symbol;              // Label of the target or NO_SYMBOL
+};
+
+/* REC_WORD, REC_BYTE, REC_ORG and REC_BSS */
+struct data_record{
+  struct record_tag tag;
   int value;
-  unsigned char wbosb;
+};
 
-  /* Next Node */
-  struct record_entry* next;
-  struct record_entry* prev;
+struct string_record{
+  struct record_tag tag;
+  unsigned short length;
+  char text[];                  // NUL terminated
 };
 
 /* Declarations */
-void add_inst_record(char*,enum INST_TYPE,char*,char*,enum ADDR_MODE,enum ADDR_MODE);
-void double_linking(struct record_entry* , struct record_entry* );
-void add_jump_record(char* , enum INST_TYPE, char* );
+unsigned add_inst_record(struct inst_el* , enum BYTE_COMB , struct operand* ,
+                         struct operand* );
+void add_jump_record(struct inst_el* , char* );
 void add_string_record(char* , unsigned short );
 void add_data_record(int , unsigned char );
 void add_org_record(unsigned short);
 void add_bss_record(unsigned short);
+void apply_fixup(unsigned , enum FIXUP_KIND , int );
+struct record_tag* first_record(void);
+struct record_tag* next_record(struct record_tag* );
+unsigned record_count(void);
+size_t record_bytes(void);
 void print_records(void);
 void clear_records(void);
+struct record_tag** record_table(void);
+void layout_shifts(struct record_tag** , unsigned , const int* , int* );
+unsigned char move_symbols(struct record_tag** , unsigned , const int* );
 
 #endif /* RECORDS_H */
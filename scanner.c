@@ -0,0 +1,215 @@
+/*
+  scanner.c
+  Block scanner for the first pass. Each block of SCAN_BLOCK chars is turned
+  into bitmasks of whitespace, newlines, ';' and '"' with SSE2 compares where
+  available, so lines, tokens and comment starts are found with bit operations
+  rather than one character at a time.
+
+  Coder: Elias Vonapartis
+  Release Date: Oct 19, 2026
+  Latest Updates: None
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include "scanner.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define BLOCK_BIT(x)  ((scan_mask)1 << (x))
+
+#ifdef __SSE2__
+/* Bits of the chars equal to c in four 16-char loads */
+static scan_mask match_sse2(const __m128i* chunk, char c){
+  const __m128i wanted = _mm_set1_epi8(c);
+
+  return (scan_mask)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk[0], wanted)) |
+         (scan_mask)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk[1], wanted)) << 16 |
+         (scan_mask)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk[2], wanted)) << 32 |
+         (scan_mask)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk[3], wanted)) << 48;
+}
+#endif /* __SSE2__ */
+
+/*
+  Classifies the SCAN_BLOCK chars starting at src, which must all be readable.
+*/
+void scan_block(const char* src, struct scan_masks* masks){
+  #ifdef __SSE2__
+  __m128i chunk[4];
+  unsigned short i;
+
+  for(i = 0; i < 4; i++){
+    chunk[i] = _mm_loadu_si128((const __m128i* )(src + 16*i));
+  }
+  masks->space = match_sse2(chunk, ' ') | match_sse2(chunk, '\t') |
+                 match_sse2(chunk, '\r');
+  masks->newline = match_sse2(chunk, '\n');
+  masks->comment = match_sse2(chunk, ';');
+  masks->quote = match_sse2(chunk, '"');
+  #else
+  unsigned short i;
+
+  memset(masks, 0, sizeof(struct scan_masks));
+  for(i = 0; i < SCAN_BLOCK; i++){
+    switch (src[i]) {
+      case ' ':
+      case '\t':
+      case '\r':
+      masks->space |= BLOCK_BIT(i);
+      break;
+      case '\n':
+      masks->newline |= BLOCK_BIT(i);
+      break;
+      case ';':
+      masks->comment |= BLOCK_BIT(i);
+      break;
+      case '"':
+      masks->quote |= BLOCK_BIT(i);
+      break;
+    }
+  }
+  #endif /* __SSE2__ */
+}
+
+/*
+  Every bit from an opening quote up to its closing quote. Each quote flips the
+  state, so this is a prefix XOR of the quote bits. inside carries the state
+  from the previous block.
+*/
+static scan_mask quoted_chars(scan_mask quote, unsigned char* inside){
+  scan_mask mask = quote;
+
+  mask ^= mask << 1;
+  mask ^= mask << 2;
+  mask ^= mask << 4;
+  mask ^= mask << 8;
+  mask ^= mask << 16;
+  mask ^= mask << 32;
+  if(*inside){
+    mask = ~mask;
+  }
+  *inside = (mask >> (SCAN_BLOCK - 1)) & 1;
+  return mask;
+}
+
+/*
+  Locates the delimiters of a NUL terminated record held in a LINE_LEN buffer.
+  The record is cut at the first ';' which is not inside quotes, so comments
+  never reach the analyzers.
+*/
+void scan_line(char* text, struct line_scan* scan){
+  struct scan_masks masks;
+  scan_mask comments;
+  scan_mask valid;
+  unsigned char inside = FALSE;
+  unsigned length = strlen(text);
+  unsigned short i;
+
+  scan->text = text;
+  scan->length = length;
+
+  for(i = 0; i < LINE_BLOCKS; i++){
+    scan_block(text + i*SCAN_BLOCK, &masks);
+
+    // Only chars before the NUL are part of the record
+    if(length <= i*SCAN_BLOCK){
+      valid = 0;
+    }
+    else if(length >= (i + 1)*SCAN_BLOCK){
+      valid = ~(scan_mask)0;
+    }
+    else{
+      valid = BLOCK_BIT(length - i*SCAN_BLOCK) - 1;
+    }
+
+    scan->delim[i] = (masks.space | masks.newline) & valid;
+    comments = masks.comment & ~quoted_chars(masks.quote, &inside) & valid;
+    if(comments && scan->length == length){
+      scan->length = i*SCAN_BLOCK + __builtin_ctzll(comments);
+      text[scan->length] = NUL;
+    }
+  }
+}
+
+/* Position of the first char at or after pos which is not a delimiter */
+unsigned skip_delims(struct line_scan* scan, unsigned pos){
+  scan_mask chars;
+  unsigned block;
+
+  for(block = pos/SCAN_BLOCK; pos < scan->length && block < LINE_BLOCKS;
+      block++, pos = block*SCAN_BLOCK){
+    chars = ~scan->delim[block] >> (pos % SCAN_BLOCK);
+    if(chars){
+      pos += __builtin_ctzll(chars);
+      break;
+    }
+  }
+  return (pos < scan->length) ? pos : scan->length;
+}
+
+/* Position of the first delimiter at or after pos, the length if none */
+unsigned find_delim(struct line_scan* scan, unsigned pos){
+  scan_mask delims;
+  unsigned block;
+
+  for(block = pos/SCAN_BLOCK; pos < scan->length && block < LINE_BLOCKS;
+      block++, pos = block*SCAN_BLOCK){
+    delims = scan->delim[block] >> (pos % SCAN_BLOCK);
+    if(delims){
+      pos += __builtin_ctzll(delims);
+      break;
+    }
+  }
+  return (pos < scan->length) ? pos : scan->length;
+}
+
+void start_file_scan(struct file_scan* scan, const char* data, size_t size){
+  scan->data = data;
+  scan->size = size;
+  scan->pos = 0;
+}
+
+/*
+  Returns the next line of the file in start and length, the newline excluded.
+  Whole blocks are searched for newline bits, the last partial block is copied
+  to a padded buffer first. Returns FALSE at the end of the file.
+*/
+unsigned char next_line(struct file_scan* scan, const char** start,
+                        size_t* length){
+  struct scan_masks masks;
+  char tail[SCAN_BLOCK];
+  size_t pos = scan->pos;
+  size_t left;
+
+  if(pos >= scan->size){
+    return FALSE;
+  }
+  *start = scan->data + pos;
+
+  while(pos < scan->size){
+    left = scan->size - pos;
+    if(left >= SCAN_BLOCK){
+      scan_block(scan->data + pos, &masks);
+    }
+    else{
+      memset(tail, 0, SCAN_BLOCK);
+      memcpy(tail, scan->data + pos, left);
+      scan_block(tail, &masks);
+    }
+    if(masks.newline){
+      pos += __builtin_ctzll(masks.newline);
+      if(pos >= scan->size){
+        break;
+      }
+      *length = pos - scan->pos;
+      scan->pos = pos + 1;
+      return TRUE;
+    }
+    pos += SCAN_BLOCK;
+  }
+  *length = scan->size - scan->pos;        // Last line without a newline
+  scan->pos = scan->size;
+  return TRUE;
+}
@@ -0,0 +1,51 @@
+#ifndef SCANNER_H
+#define SCANNER_H
+
+/*
+  scanner.h
+  Header file for scanner.c
+
+  Coder: Elias Vonapartis
+  Release Date: Oct 19, 2026
+  Latest Updates: None
+*/
+
+#include <stddef.h>
+#include "parser.h"
+
+#define SCAN_BLOCK    64                    // Chars classified per step
+#define LINE_BLOCKS   (LINE_LEN/SCAN_BLOCK)
+
+typedef unsigned long long scan_mask;
+
+/* One bit per char of a block, bit 0 being the first char */
+struct scan_masks{
+  scan_mask space;      // ' ', '\t' and '\r'
+  scan_mask newline;    // '\n'
+  scan_mask comment;    // ';'
+  scan_mask quote;      // '"'
+};
+
+/* A record with its delimiters located, see scan_line() */
+struct line_scan{
+  char* text;
+  unsigned length;                  // Up to the comment, if any
+  scan_mask delim[LINE_BLOCKS];     // Whitespace and newlines
+};
+
+/* Splits a whole source file into lines */
+struct file_scan{
+  const char* data;
+  size_t size;
+  size_t pos;
+};
+
+/* Function Declarations */
+void scan_block(const char* , struct scan_masks* );
+void scan_line(char* , struct line_scan* );
+unsigned skip_delims(struct line_scan* , unsigned );
+unsigned find_delim(struct line_scan* , unsigned );
+void start_file_scan(struct file_scan* , const char* , size_t );
+unsigned char next_line(struct file_scan* , const char** , size_t* );
+
+#endif /* SCANNER_H */
@@ -1,9 +1,9 @@
 /*
   secondpass.c
   This module contains the secondpass() function as well as functions which
-  analyze tokens in the record linked-list to combine all the required data
-  using the emit functions in emit.c and following that tranlating the output
-  form the emits to srecord characters.
+  analyze tokens in the records to combine all the required data
+  using the emit functions in emit.c and following that writing the output
+  from the emits into the memory image in srec_gen.c.
 
   Coder: Elias Vonapartis
   Release Date: May 28, 2016
@@ -13,6 +13,19 @@
                                 - Added jump forward reference support
                   June 14, 2016 - Fixed Indexed back to absolute base address
                                 - Fixed Relative calculation
+                  Oct 19, 2026  - Operands come classified from the first pass
+                                - Extension words are written when they are
+                                  zero
+                                - Symbols resolved by ID
+                                - Instructions encoded from the templates
+                                - Operands decoded with the mode descriptors
+                                - Symbol values come patched into the records
+                                - Dispatch on the tag of the compact records
+                                - Records decoded into columns and encoded in
+                                  one loop
+                                - Records decoded, encoded and listed in
+                                  ranges on several threads
+                                - Records removed by the peephole pass listed
 */
 
 #include <stdio.h>
@@ -27,26 +40,25 @@
 #include "emit.h"
 #include "srec_gen.h"
 #include "records.h"
-
-unsigned as_value[] = {0, 1, 1, 1, 2, 3, 3};
-unsigned ad_value[] = {0, 1, 1, 1};
-
-// Last minute solution to imm consts, no need for -1 and 8 cases since they use
-// the same AS as Immediate mode
-unsigned as_consts[] = {0, 1, 2, 0, 2};
-
-char    reg_value[] = {-1, -1, PC_REG, SR_REG, -1, -1, PC_REG};
+#include "parallel.h"
+#include "jumps.h"
 
 /*
   This function contains the processes required to decode the assembly records
-  in the linked list from the first pass output. It sorts the recors into
-  instructions & storage directives, decodes the contents of the data and outputs
-  them to an srecord file.
+  in the record buffer from the first pass output. Once the first pass is done
+  every label is resolved and every record has its LC, so a record is decoded,
+  encoded and listed without looking at any other. The rows are split into
+  ranges for that, done on several threads. Only the writes to the image are
+  made on this thread, in source order, so that a warning about an address
+  written twice goes to the same record as before. The listings of the ranges
+  are then written out in order.
 */
 
 void secondpass(void){
-  struct record_entry* record = head;
-  srec = fopen("srecords.s19", "w");
+  struct pass_columns cols;
+  struct pass_job job;
+  unsigned r;
+  clear_image();
 
   printf("\n----------Entered Second Pass Function----------\n");
   fprintf(fout, "\n--------------Second Pass Diagnostic Opcode--------------\n");
@@ -55,384 +67,501 @@ void secondpass(void){
                 " and source and destination operand values.\nA value of 0000"
                 " means non-existing value\n");
 
-  while(record){
-    printf("\n----------RECORD: %d----------\n", record->line);
-    fprintf(fout, "\n----------RECORD: %d----------\n", record->line);
-    if(record->inst){
-      switch (record->type) {
-        case SINGLE:
-        printf("SINGLE\n");
-        type1_inst(record);
-        break;
-        case DOUBLE:
-        printf("DOUBLE\n");
-        type2_inst(record);
-        break;
-        case JUMP:
-        printf("JUMP\n");
-        type3_inst(record);
-        break;
-        case NONE:
-        printf("NONE\n");
-        struct inst_el* instptr = get_inst(record->inst);
-        srec_gen(instptr->opcode, record->LC, WORDSIZE);
-        printf("Output: %04x\n", instptr->opcode);
-        break;
-        default:
-        #ifdef debug2
-        printf("Internal Error in Second Pass function\n");
-        #endif
-      }
+  load_columns(&cols);
+  memset(&job, 0, sizeof(job));
+  job.cols = &cols;
+  job.ranges = (cols.count + PASS_RANGE_ROWS - 1) / PASS_RANGE_ROWS;
+  job.listing = calloc(job.ranges, sizeof(*job.listing));
+  job.listing_len = calloc(job.ranges, sizeof(*job.listing_len));
+  job.trace = calloc(job.ranges, sizeof(*job.trace));
+  job.trace_len = calloc(job.ranges, sizeof(*job.trace_len));
+
+  parallel_for(job.ranges, 1, encode_ranges, &job);
+  place_rows(&job);
+  parallel_for(job.ranges, 1, list_ranges, &job);
+
+  for(r = 0; r < job.ranges; r++){
+    fwrite(job.trace[r], 1, job.trace_len[r], stdout);
+    fwrite(job.listing[r], 1, job.listing_len[r], fout);
+    free(job.trace[r]);
+    free(job.listing[r]);
+  }
+  free(job.trace);
+  free(job.trace_len);
+  free(job.listing);
+  free(job.listing_len);
+  free(job.clashes);
+  free_columns(&cols);
+
+  /*
+    The records have been read, so the image is complete. Store the starting
+    address determined in the first pass and a snapshot of the labels for the
+    output writers.
+  */
+  image.start = start_address;
+  image.symbols = snapshot_symboltable(&image.symbol_count);
+}
+
+/*
+  Allocates the columns, one zeroed row per record, and fills in the row of
+  each record with where it is. Rows are decoded by decode_row().
+*/
+void load_columns(struct pass_columns* cols){
+  struct record_tag* record;
+  unsigned count = record_count();
+  unsigned i = 0;
+
+  cols->count = count;
+  cols->kind = calloc(count, sizeof(*cols->kind));
+  cols->flags = calloc(count, sizeof(*cols->flags));
+  cols->LC = calloc(count, sizeof(*cols->LC));
+  cols->word = calloc(count, sizeof(*cols->word));
+  cols->src = calloc(count, sizeof(*cols->src));
+  cols->as = calloc(count, sizeof(*cols->as));
+  cols->ad = calloc(count, sizeof(*cols->ad));
+  cols->dst = calloc(count, sizeof(*cols->dst));
+  cols->ext0 = calloc(count, sizeof(*cols->ext0));
+  cols->ext1 = calloc(count, sizeof(*cols->ext1));
+  cols->tag = calloc(count, sizeof(*cols->tag));
+
+  for(record = first_record(); record; record = next_record(record), i++){
+    cols->kind[i] = record->kind;
+    cols->LC[i] = record->LC;
+    cols->tag[i] = record;
+  }
+}
+
+void free_columns(struct pass_columns* cols){
+  free(cols->kind);
+  free(cols->flags);
+  free(cols->LC);
+  free(cols->word);
+  free(cols->src);
+  free(cols->as);
+  free(cols->ad);
+  free(cols->dst);
+  free(cols->ext0);
+  free(cols->ext1);
+  free(cols->tag);
+}
+
+/*
+  Decodes the record of row i into the columns. The fields a record does not
+  use stay 0 and leave the encoding untouched. Data records keep their value
+  in word, which encode_columns() then leaves as it is.
+*/
+void decode_row(struct pass_columns* cols, unsigned i){
+  struct record_tag* record = cols->tag[i];
+
+  switch (record->kind) {
+    case REC_SINGLE:
+    type1_inst((struct inst_record*)record, cols, i);
+    break;
+    case REC_DOUBLE:
+    type2_inst((struct inst_record*)record, cols, i);
+    break;
+    case REC_JUMP:
+    type3_inst((struct jump_record*)record, cols, i);
+    break;
+    case REC_NONE:
+    cols->word[i] = inst_list[((struct inst_record*)record)->inst].
+                    encoding[WORD];
+    break;
+    case REC_WORD:
+    case REC_BYTE:
+    cols->word[i] = ((struct data_record*)record)->value;
+    break;
+    default:                          // ORG, BSS and strings are not encoded
+    break;
+  }
+}
+
+/* parallel_for() work function, decodes and encodes the ranges [begin, end) */
+void encode_ranges(unsigned begin, unsigned end, void* arg){
+  struct pass_job* job = arg;
+  struct pass_columns* cols = job->cols;
+  unsigned first;
+  unsigned last;
+  unsigned i;
+
+  for(; begin < end; begin++){
+    first = begin * PASS_RANGE_ROWS;
+    last = first + PASS_RANGE_ROWS < cols->count ? first + PASS_RANGE_ROWS :
+                                                   cols->count;
+    for(i = first; i < last; i++){
+      decode_row(cols, i);
     }
-    else{
-      // wbosb = word byte org string bss
-      switch (record->wbosb) {
-        case WORD2:
-        printf("\n----------Data %d on RECORD: %d----------\n", record->value,
-                                                                record->line);
-        srec_gen(record->value, record->LC, WORDSIZE);
-        break;
-        case BYTE2:
-        printf("\n----------Data %d on RECORD: %d----------\n", record->value,
-                                                                record->line);
-        srec_gen(record->value, record->LC, BYTESIZE);
-        break;
-        case ORG2:
-        printf("\n----------ORG %04x----------\n", record->value);
-        srec_org(record->value);
-        break;
-        case STRING2:
-        printf("\n----------RECORD: %d----------\n", record->line);
-        printf("String: %s\n", record->string);
-        srec_char(record->string, record->LC);
-        break;
-        case BSS2:
-        printf("\n----------RECORD: %d----------\n", record->line);
-        printf("BSS Value: %d\n", record->value);
-        srec_bss(record->value, record->LC);
-        break;
-        default:
-        printf("Something has broken in secondpass().\n");
+    encode_columns(last - first, cols->word + first, cols->src + first,
+                   cols->as + first, cols->ad + first, cols->dst + first);
+  }
+}
+
+/* Keeps an address row wrote over, for list_row() to report */
+void add_clash(struct pass_job* job, unsigned row, unsigned short address){
+  if(job->clash_count == job->clash_size){
+    job->clash_size = job->clash_size ? job->clash_size * 2 : CLASH_INIT;
+    job->clashes = realloc(job->clashes,
+                           job->clash_size * sizeof(*job->clashes));
+  }
+  job->clashes[job->clash_count].row = row;
+  job->clashes[job->clash_count].address = address;
+  job->clash_count++;
+}
+
+/* Writes a datum of row to the image, keeping the addresses written twice */
+void place_row_datum(struct pass_job* job, unsigned row, unsigned short datum,
+                     unsigned short location, unsigned char bw){
+  unsigned char clashes = place_datum(datum, location, bw);
+  unsigned short i;
+
+  for(i = 0; clashes; i++, clashes >>= 1){
+    if(clashes & 1){
+      add_clash(job, row, location + i);
+    }
+  }
+}
+
+/*
+  Writes every row to the image in source order: the instruction word, then
+  its extension words, or the data. A jump with an error is not written.
+*/
+void place_rows(struct pass_job* job){
+  struct pass_columns* cols = job->cols;
+  struct string_record* str;
+  unsigned short words[LONG_JUMP_WORDS];
+  unsigned n;
+  unsigned short LC;
+  unsigned char flags;
+  unsigned i;
+  unsigned j;
+
+  for(i = 0; i < cols->count; i++){
+    LC = cols->LC[i];
+    flags = cols->flags[i];
+    switch (cols->kind[i]) {
+      case REC_SINGLE:
+      case REC_DOUBLE:
+      place_row_datum(job, i, cols->word[i], LC, WORDSIZE);
+      if(flags & COL_EXT_SRC){
+        place_row_datum(job, i, cols->ext0[i], LC + WORDINC, WORDSIZE);
+      }
+      // The destination word follows the source word only when there is one
+      if(flags & COL_EXT_DST){
+        place_row_datum(job, i, cols->ext1[i], LC + (flags & COL_EXT_SRC ?
+                        DOUBLEWORDINC : WORDINC), WORDSIZE);
+      }
+      break;
+      case REC_JUMP:
+      if(flags & (COL_JUMP_FAR | COL_JUMP_ODD)){
         break;
       }
+      if(flags & COL_JUMP_LONG){
+        n = long_jump_words((struct jump_record*)cols->tag[i], words);
+        for(j = 0; j < n; j++){
+          place_row_datum(job, i, words[j], LC + j*WORDINC, WORDSIZE);
+        }
+      }
+      else{
+        place_row_datum(job, i, cols->word[i], LC, WORDSIZE);
+      }
+      break;
+      case REC_NONE:
+      case REC_WORD:
+      place_row_datum(job, i, cols->word[i], LC, WORDSIZE);
+      break;
+      case REC_BYTE:
+      place_row_datum(job, i, cols->word[i], LC, BYTESIZE);
+      break;
+      case REC_STRING:
+      str = (struct string_record*)cols->tag[i];
+      for(j = 0; j < str->length; j++){
+        place_row_datum(job, i, str->text[j], LC + j, BYTESIZE);
+      }
+      break;
+      default:
+      break;
     }
-    record = record->next;
   }
-  /*
-    The linked list has been read, so now emit the remaining bytes in the srecs
-    that have been added but not emitted and then emit the terminating s9 record
-    with the global value determined in the first pass.
-  */
-  emit_srec();
-  emit_s9(start_address);
 }
 
-void type1_inst(struct record_entry* singleinst){
-  struct inst_el *instptr;
-  struct single_op inst;
-  unsigned char as;
-  unsigned char reg;
-  int val = 0;
-  unsigned short inst_out;
-
-  instptr = get_inst(singleinst->inst);
-  reg = reg_value[singleinst->src_mode];
-  numval_extractor(singleinst->src_mode, singleinst->src_op, &val, &reg, &as, singleinst->LC);
-  inst_out = emit_single(reg, as, instptr->bw, instptr->opcode);
-  srec_gen(inst_out, singleinst->LC, WORDSIZE);
-
-  // If there is a value write it in the next location, note in constant generator
-  // circumstances value has been set to 0.
-  if(val){
-    printf("In the single inst we have a value of %04x\n", val);
-    srec_gen(val, (singleinst->LC + WORDINC), WORDSIZE);
+/*
+  parallel_for() work function, lists the rows of the ranges [begin, end) into
+  the listing and trace of each range.
+*/
+void list_ranges(unsigned begin, unsigned end, void* arg){
+  struct pass_job* job = arg;
+  unsigned count = job->cols->count;
+  unsigned clash = 0;
+  unsigned first;
+  unsigned last;
+  unsigned i;
+  FILE* out;
+  FILE* trace;
+
+  for(; begin < end; begin++){
+    first = begin * PASS_RANGE_ROWS;
+    last = first + PASS_RANGE_ROWS < count ? first + PASS_RANGE_ROWS : count;
+    while(clash < job->clash_count && job->clashes[clash].row < first){
+      clash++;
+    }
+    out = open_memstream(&job->listing[begin], &job->listing_len[begin]);
+    trace = open_memstream(&job->trace[begin], &job->trace_len[begin]);
+    for(i = first; i < last; i++){
+      list_row(job, i, &clash, out, trace);
+    }
+    fclose(out);
+    fclose(trace);
   }
+}
 
-  opcode_printer(inst_out, val, 0, SINGLE);
+/*
+  Lists row i to out, the diagnostics, and to trace, the terminal. clash is the
+  first clash not listed yet, the clashes of row i are listed and skipped.
+*/
+void list_row(struct pass_job* job, unsigned i, unsigned* clash, FILE* out,
+              FILE* trace){
+  struct pass_columns* cols = job->cols;
+  struct record_tag* record = cols->tag[i];
+  unsigned char flags = cols->flags[i];
+  unsigned short words[LONG_JUMP_WORDS];
+  unsigned n;
+  unsigned k;
+
+  fprintf(trace, "\n----------RECORD: %d----------\n", record->line);
+  fprintf(out, "\n----------RECORD: %d----------\n", record->line);
+  for(; *clash < job->clash_count && job->clashes[*clash].row == i; (*clash)++){
+    fprintf(out, "WARNING: Address %04x is written more than once\n",
+            job->clashes[*clash].address);
+  }
 
+  switch (cols->kind[i]) {
+    case REC_SINGLE:
+    case REC_DOUBLE:
+    trace_inst(cols, i, trace);
+    opcode_printer(out, cols->word[i], cols->ext0[i], cols->ext1[i],
+                   cols->kind[i] == REC_SINGLE ? SINGLE : DOUBLE);
+    break;
+    case REC_JUMP:
+    trace_inst(cols, i, trace);
+    if(flags & COL_JUMP_FAR){
+      fprintf(out, "ERROR: The offset used in record %d is beyond the maximum "
+             "attainable\n", record->line);
+    }
+    else if(flags & COL_JUMP_ODD){
+      fprintf(out, "ERROR: Invalid odd address %d for offset in record %d\n",
+            cols->ext0[i], record->line);
+    }
+    else if(flags & COL_JUMP_LONG){
+      n = long_jump_words((struct jump_record*)record, words);
+      fprintf(out, "Relaxed Jump Opcodes:");
+      for(k = 0; k < n; k++){
+        fprintf(out, " %04x", words[k]);
+      }
+      fprintf(out, "\n");
+    }
+    else{
+      opcode_printer(out, cols->word[i], 0, 0, JUMP);
+    }
+    break;
+    case REC_NONE:
+    fprintf(trace, "NONE\nOutput: %04x\n", cols->word[i]);
+    break;
+    case REC_REMOVED:
+    fprintf(trace, "Removed\n");
+    fprintf(out, "Removed by the peephole pass\n");
+    break;
+    case REC_WORD:
+    case REC_BYTE:
+    fprintf(trace, "\n----------Data %d on RECORD: %d----------\n",
+            cols->word[i], record->line);
+    break;
+    case REC_ORG:
+    fprintf(trace, "\n----------ORG %04x----------\n",
+            ((struct data_record*)record)->value);
+    break;
+    case REC_STRING:
+    fprintf(trace, "String: %s\n", ((struct string_record*)record)->text);
+    break;
+    case REC_BSS:
+    fprintf(trace, "BSS Value: %d\n", ((struct data_record*)record)->value);
+    break;
+    default:
+    fprintf(trace, "Something has broken in secondpass().\n");
+    break;
+  }
+}
+
+/* Traces the decoded fields of an instruction row */
+void trace_inst(struct pass_columns* cols, unsigned i, FILE* trace){
+  struct record_tag* record = cols->tag[i];
+  struct inst_record* inst = (struct inst_record*)record;
+  struct jump_record* jump = (struct jump_record*)record;
+
+  switch (record->kind) {
+    case REC_SINGLE:
+    fprintf(trace, "SINGLE %s\n", inst_list[inst->inst].inst);
+    #ifdef debug2
+    fprintf(trace, "BW: %d\nAs: %d\nSource: %s\nSource reg: %d\n", inst->bw,
+            cols->as[i], symbol_name(inst->op[0].symbol), cols->dst[i]);
+    #endif /* debug2 */
+    break;
+    case REC_DOUBLE:
+    fprintf(trace, "DOUBLE %s\n", inst_list[inst->inst].inst);
+    #ifdef debug2
+    fprintf(trace, "Source: %s\nSource reg: %d\nAd: %d\nBW: %d\nAs: %d\n"
+            "Destination: %s\nDestination reg: %d\n",
+            symbol_name(inst->op[0].symbol), cols->src[i], cols->ad[i],
+            inst->bw, cols->as[i], symbol_name(inst->op[1].symbol),
+            cols->dst[i]);
+    #endif /* debug2 */
+    break;
+    default:
+    fprintf(trace, "JUMP %s\n", inst_list[jump->inst].inst);
+    #ifdef debug2
+    fprintf(trace, "Target: %s\nOffset is: %d\n", symbol_name(jump->symbol),
+            jump->offset);
+    #endif /* debug2 */
+    break;
+  }
   #ifdef debug2
-  printf("\nOpcode: %04x\n", instptr->opcode);
-  printf("BW: %d\n", instptr->bw);
-  printf("As: %d\n", as);
-  printf("Source: %s\n", singleinst->src_op);
-  if(singleinst->src_mode == RELATIVE ||
-     singleinst->src_mode == ABSOLUTE ||
-     singleinst->src_mode == IMMEDIATE){
-       printf("We have a value %d\n", val);
+  if(cols->flags[i] & COL_EXT_SRC){
+    fprintf(trace, "Source Value: %d\n", cols->ext0[i]);
+  }
+  if(cols->flags[i] & COL_EXT_DST){
+    fprintf(trace, "Destination Value: %d\n", cols->ext1[i]);
   }
-  printf("Source reg: %d\n", reg);
-  printf("Output: %04x\n", inst_out);
   #endif /* debug2 */
-  return;
+  fprintf(trace, "Output: %04x\n", cols->word[i]);
 }
 
-void type2_inst(struct record_entry* doubleinst){
-  struct inst_el *instptr;
-  struct double_op inst;
+void type1_inst(struct inst_record* singleinst, struct pass_columns* cols,
+                unsigned i){
+  unsigned char as;
+  unsigned char reg;
+  int val = 0;
+
+  if(numval_extractor(&singleinst->op[0], &val, &reg, &as,
+                      singleinst->tag.LC)){
+    cols->flags[i] = COL_EXT_SRC;
+  }
+  cols->word[i] = inst_list[singleinst->inst].encoding[singleinst->bw];
+  cols->dst[i] = reg & REG_MASK;
+  cols->as[i] = as & AS_MASK;
+  cols->ext0[i] = val;
+}
+
+void type2_inst(struct inst_record* doubleinst, struct pass_columns* cols,
+                unsigned i){
+  struct record_operand* src = &doubleinst->op[0];
+  struct record_operand* dst = &doubleinst->op[1];
   unsigned char as;
-  unsigned char ad;
   unsigned char junk;
   unsigned char sreg;
   unsigned char dreg;
+  unsigned char flag_src_ext;
+  unsigned char flag_dst_ext;
   int val0 = 0;
   int val1 = 0;
-  unsigned short inst_out;
-
-  instptr = get_inst(doubleinst->inst);
-  ad = ad_value[doubleinst->dst_mode];
-  sreg = reg_value[doubleinst->src_mode];
-  dreg = reg_value[doubleinst->dst_mode];
-  numval_extractor(doubleinst->src_mode, doubleinst->src_op, &val0, &sreg, &as,
-		   doubleinst->LC);
-  numval_extractor(doubleinst->dst_mode, doubleinst->dst_op, &val1, &dreg, &junk,
-		   doubleinst->LC);
-  inst_out = emit_double(dreg, as, instptr->bw, ad, sreg, instptr->opcode);
-  srec_gen(inst_out, doubleinst->LC, WORDSIZE);
-
-  if(val0){
-    printf("We have a val0 %d\n", val0);
-    printf("We use for val0 an lc of %d\n", doubleinst->LC + WORDINC);
-    srec_gen(val0, (doubleinst->LC + WORDINC), WORDSIZE);
-  }
-  if(val1){ // Meaning Indexed, Relative or Absolute
-    printf("We have a val1 %d\n", val1);
-    if(val0 && (doubleinst->dst_mode == RELATIVE)){ // So dst either idx, rel
-      val1 -= WORDINC;  // decrement the signed distance, i.e has higher LC
-      printf("New val1 for rel %d\n", val1);
-    }
-    srec_gen(val1, (doubleinst->LC + DOUBLEWORDINC), WORDSIZE);
-  }
 
-  opcode_printer(inst_out, val0, val1, DOUBLE);
-
-  #ifdef debug2
-  printf("\nOpcode: %04x\n", instptr->opcode);
-  printf("Source: %s\n", doubleinst->src_op);
-  if(doubleinst->src_mode == RELATIVE ||
-     doubleinst->src_mode == ABSOLUTE ||
-     doubleinst->src_mode == IMMEDIATE){
-       printf("Source Value: %d\n", val0);
-  }
-  printf("Source reg: %d\n", sreg);
-  printf("Ad: %d\n", ad);
-  printf("BW: %d\n", instptr->bw);
-  printf("As: %d\n", as);
-  printf("Destination: %s\n", doubleinst->dst_op);
-  if(doubleinst->dst_mode == RELATIVE ||
-     doubleinst->dst_mode == ABSOLUTE ||
-     doubleinst->dst_mode == IMMEDIATE){
-       printf("Destination Value: %d\n", val1);
+  flag_src_ext = numval_extractor(src, &val0, &sreg, &as, doubleinst->tag.LC);
+  flag_dst_ext = numval_extractor(dst, &val1, &dreg, &junk, doubleinst->tag.LC);
+  if(flag_dst_ext && flag_src_ext && (dst->mode == RELATIVE)){
+    val1 -= WORDINC;  // decrement the signed distance, i.e has higher LC
   }
-  printf("Destination reg: %d\n", dreg);
-  printf("Output: %04x\n", inst_out);
-  #endif /* debug2 */
-  return;
+
+  cols->word[i] = inst_list[doubleinst->inst].encoding[doubleinst->bw];
+  cols->src[i] = sreg & REG_MASK;
+  cols->as[i] = as & AS_MASK;
+  cols->ad[i] = mode_desc_of(dst->mode, dst->constgen, dst->value)->ad &
+                AD_MASK;
+  cols->dst[i] = dreg & REG_MASK;
+  cols->flags[i] = (flag_src_ext ? COL_EXT_SRC : 0) |
+                   (flag_dst_ext ? COL_EXT_DST : 0);
+  cols->ext0[i] = val0;
+  cols->ext1[i] = val1;
 }
 
-void type3_inst(struct record_entry* jumpinst){
-  struct inst_el *instptr;
-  struct double_op inst;
-  struct symbol_entry* symbol;
+/*
+  Decodes a jump. A target out of reach or at an odd distance is flagged for
+  list_row() to report, the odd distance kept in ext0. The long form of a
+  relaxed jump reaches any even address, its first word goes in word.
+*/
+void type3_inst(struct jump_record* jumpinst, struct pass_columns* cols,
+                unsigned i){
+  unsigned short words[LONG_JUMP_WORDS];
   unsigned short offset;
   short distance;
   short halfdist;
-  unsigned short inst_out;
 
-  instptr = get_inst(jumpinst->inst);
-  if(jumpinst->src_op){                   // Indicative of a forward reference
-    symbol = get_entry(jumpinst->src_op);
-    offset = symbol->value;
-  }
-  else{
-    offset = jumpinst->offset;
-  }
-
-  printf("Offset is: %d\n", offset);
-  distance = offset - (jumpinst->LC + WORDINC);
-  printf("jumpinst->LC is %d\n", jumpinst->LC);
+  offset = jumpinst->offset;          // Labels patched in by their fixups
+  distance = offset - (jumpinst->tag.LC + WORDINC);
   halfdist = half_value(distance);
 
-  #ifdef debug2
-  printf("Full distance is %d\n", distance);
-  printf("Half distance is %d\n", halfdist);
-  #endif /* debug2 */
-
-  if(distance >= MAX_POS_OFFSET || distance <= MAX_NEG_OFFSET){
-    fprintf(fout, "ERROR: The offset used in record %d is beyond the maximum "
-           "attainable\n", jumpinst->line);
+  cols->word[i] = inst_list[jumpinst->inst].encoding[WORD];
+  if(jumpinst->form == JUMP_LONG){
+    long_jump_words(jumpinst, words);
+    cols->word[i] = words[0];
+    cols->flags[i] = COL_JUMP_LONG;
+    if(offset % 2){
+      cols->flags[i] |= COL_JUMP_ODD;
+      cols->ext0[i] = distance;
+    }
+  }
+  else if(distance >= MAX_POS_OFFSET || distance <= MAX_NEG_OFFSET){
+    cols->flags[i] = COL_JUMP_FAR;
   }
   else if((distance)%2){
-    fprintf(fout, "ERROR: Invalid odd address %d for offset in record %d\n",
-          distance, jumpinst->line);
+    cols->flags[i] = COL_JUMP_ODD;
+    cols->ext0[i] = distance;
   }
   else{
-    inst_out = emit_jump(halfdist, instptr->opcode);
-    srec_gen(inst_out, jumpinst->LC, WORDSIZE);
-    opcode_printer(inst_out, 0, 0, JUMP);
+    cols->dst[i] = halfdist & OFFSET_MASK;
   }
-
-
-
-  #ifdef debug2
-  printf("\nOpcode: %04x\n", instptr->opcode);
-  printf("Offset: %d\n", halfdist);
-  printf("Output: %04x\n", inst_out);
-  #endif /* debug2 */
-  return;
 }
 
 /*
-  This function determines 'as', the source and destination registers as well as
-  any numeric values that are needed for the opcode generation. 'as' was a later
-  addition to handle cases in which immdiate constants were being used.
+  This function determines 'as', the register and the extension word of an
+  operand from the classification made in the first pass and the addressing
+  mode descriptors, the same ones the first pass sized the instruction with.
+  Returns TRUE if the operand needs an extension word.
 */
-void numval_extractor(enum ADDR_MODE mode, char* src, int* value,
+unsigned char numval_extractor(struct record_operand* op, int* value,
                       unsigned char* reg, unsigned char* as, int lc){
-  char* temp = src;
-  char* index;
-  char* baseaddress;
-  char* ptr;
-  struct symbol_entry* symbol;
-  unsigned short i = 0;
-
-  switch (mode) {
-    case INDIRECT:
-    case INDIRECT_INCR:
-    /* Not searching for the +, it does not get passed by the first pass */
-    *temp++; // Remove the @
-    case REGISTER:
-    if(symbol = get_entry(temp)){  // In the case the coder is using an alias
-      *reg = symbol->value;        // such as sp, pc
-      *as = as_value[mode];
-      break;
-    }
-    *temp++;                         // Remove the R
-    *reg = is_number(temp);          // Retrieve register value
-    *as = as_value[mode];            // Set as
-    #ifdef debug2
-    printf("R, @R, @R+\n");
-    printf("*as is %d\n", *as);
-    printf("*reg is %d\n", *reg);
-    #endif
-    break;
-    case IMMEDIATE:
-    *reg = PC_REG;
-    *temp++;
-    if(symbol = get_entry(temp)){    // Immediate can be used wth symbols
-      *value = symbol->value;
-    }
-    else{
-      *value = is_number(temp);      // Else it's a numeric
-    }
-    *as = as_value[mode];
-    if(CONGEN(*value)){              // Check if values retrieved are consts
-      switch (*value) {
-        case 0:
-        case 1:
-        case 2:
-        *as = as_consts[*value];     // Common AS for 0, 1, 2
-        case -1:
-        *reg = CG_REG;  // In -1, 0, 1, 2 cases use R3 for register
-        if(*value == -1){
-          *as = as_value[mode];
-        }
-        break;
-        case 4:
-        *as = as_consts[*value];
-        case 8:
-        *reg = SR_REG;  // Use R2
-        if(*value == 8){
-          *as = as_value[mode];
-        }
-        break;
-      }
-      *value = 0;    // Indicate that there is no data to be written
-    }
-    #ifdef debug2
-    printf("IMMEDIATE\n");
-    printf("*value is %d\n", *value);
-    printf("*as is %d\n", *as);
-    printf("*reg is %d\n", *reg);
-    #endif
-    break;
-    case ABSOLUTE:
-    *reg = SR_REG;
-    *temp++;
-    if(symbol = get_entry(temp)){
-      *value = (symbol->value);
-    }
-    else{
-      *value = is_number(temp);
-    }
-    *as = as_value[mode];
-    break;
-    case RELATIVE:
-    *reg = PC_REG;
-    if(symbol = get_entry(temp)){
-      *value = (symbol->value) - (lc + DOUBLEWORDINC);
-      #ifdef debug2
-      printf("lc used was %d\n", lc);
-      printf("Found LC diff %d\n", *value);
-      #endif
-    }
-    else{
-      *value = is_number(temp) - (lc + DOUBLEWORDINC);
-      #ifdef debug2
-      printf("lc used was %d\n", lc);
-      printf("Found LC diff2 %d\n", *value);
-      #endif
-    }
-    *as = as_value[mode];
-    break;
-    case INDEXED:
-    baseaddress = (char* )malloc(sizeof(char)*MAX_NAME_LEN);
-    index = (char* )malloc((sizeof(char))*REG_SIZE);
+  const struct mode_desc* desc;
 
-    ptr = strstr(temp, "(");
-    *ptr++;
-
-    for(i = 0; ptr[i] != ')'; i++){
-      index[i] = ptr[i];
-    }
-    symbol = get_entry(index);
-    *reg = symbol->value;
+  if(op->mode == BAD_ADDR_MODE){
+    return FALSE;
+  }
+  desc = mode_desc_of(op->mode, op->constgen, op->value);
+  *value = op->value;                // Symbol values included, see fixups
+  *reg = desc->reg == NO_REG ? op->reg : desc->reg;
+  *as = desc->as;
 
-    #ifdef debug2
-    printf("Index Register is: %d\n", *reg);
-    #endif
-
-    /* Now to find the base address */
-    i = 0; // Reset the counter
-
-    while(temp[i] != '('){        // Search for the opening parenthesis
-      baseaddress[i] = temp[i];
-      i++;                        // No need to break at MAX_NAME_LEN since
-    }                             // is_label checks
-    symbol = get_entry(baseaddress);
-    *value = (symbol->value);
-    *as = as_value[mode];
-    #ifdef debug2
-    printf("Base Address Value %d\n", *value);
-    #endif
-    break;
+  if(desc->ext_words == 0){
+    *value = 0;      // Indicate that there is no data to be written
+  }
+  else if(desc->pc_bias){
+    *value -= lc + desc->pc_bias;
   }
+  return desc->ext_words != 0;
 }
 
 /* This function has been written simply for diagnostic purposes */
-void opcode_printer(unsigned short inst, int val0, int val1, unsigned char type){
+void opcode_printer(FILE* out, unsigned short inst, int val0, int val1,
+                    unsigned char type){
   switch (type) {
     case SINGLE:
-    fprintf(fout, "Instruction Opcode: %04x\n"
-                  "Source Value: %04x",
-                   inst, val0);
+    fprintf(out, "Instruction Opcode: %04x\n"
+                 "Source Value: %04x",
+                  inst, val0);
     break;
     case DOUBLE:
-    fprintf(fout, "Instruction Opcode: %04x\n"
-                  "Source Value: %04x\nDestination Value: %04x\n",
-                   inst, val0, val1);
+    fprintf(out, "Instruction Opcode: %04x\n"
+                 "Source Value: %04x\nDestination Value: %04x\n",
+                  inst, val0, val1);
     break;
     default:
-    fprintf(fout, "Instruction Opcode: %04x\n", inst);
+    fprintf(out, "Instruction Opcode: %04x\n", inst);
     break;
   }
 }
@@ -7,7 +7,11 @@
 
   Coder: Elias Vonapartis
   Release Date: May 28, 2016
-  Latest Updates: None
+  Latest Updates: Oct 19, 2026  - Mode facts moved to the descriptor table
+                                - Passes take the compact records
+                                - Added the columns of the second pass
+                                - Ranges of the second pass run in parallel
+                                - Long form of relaxed jumps
 */
 
 #include "records.h"
@@ -16,9 +20,6 @@
 
 #define MAX_POS_OFFSET  1024    // As per the inst manual
 #define MAX_NEG_OFFSET  -1022
-#define PC_REG    0
-#define SR_REG    2
-#define CG_REG    3
 #define WORDSIZE  0
 #define BYTESIZE  1
 
@@ -28,12 +29,78 @@
 
 #define half_value(x) (x >> 1)
 
+/* Flags of a row of the columns */
+#define COL_EXT_SRC   0x01    // Source extension word in ext0
+#define COL_EXT_DST   0x02    // Destination extension word in ext1
+#define COL_JUMP_FAR  0x04    // Jump target out of reach
+#define COL_JUMP_ODD  0x08    // Jump distance odd, kept in ext0
+#define COL_JUMP_LONG 0x10    // Relaxed jump, see long_jump_words()
+
+/*
+  The records as the second pass streams them, one array per field and one row
+  per record in source order. The fields of the instruction word are kept apart
+  so encode_columns() can merge them for all the rows in one pass. A data
+  record has its value in word and the other fields 0.
+*/
+struct pass_columns{
+  unsigned count;
+  unsigned char* kind;          // RECORD_KIND
+  unsigned char* flags;
+  unsigned short* LC;
+  unsigned short* word;         // Template, encoded in place
+  unsigned char* src;           // Source register
+  unsigned char* as;
+  unsigned char* ad;
+  unsigned short* dst;          // Destination register or jump word offset
+  int* ext0;                    // Source extension word
+  int* ext1;                    // Destination extension word
+  struct record_tag** tag;      // The record, for what is only listed
+};
+
+#define PASS_RANGE_ROWS 1024    // Rows per range of the second pass
+#define CLASH_INIT      16
+
+/* An address written again by a row, reported as a warning */
+struct clash{
+  unsigned row;
+  unsigned short address;
+};
+
+/*
+  The work of the second pass on its ranges of rows. Each range is listed into
+  a buffer of its own, written out in order once all of them are done. The
+  clashes are in row order, as the rows are written to the image in order.
+*/
+struct pass_job{
+  struct pass_columns* cols;
+  unsigned ranges;
+  char** listing;               // Diagnostics of each range
+  size_t* listing_len;
+  char** trace;                 // Terminal output of each range
+  size_t* trace_len;
+  struct clash* clashes;
+  unsigned clash_count;
+  unsigned clash_size;
+};
+
 /* Declarations */
 void secondpass(void);
-void type1_inst(struct record_entry* );
-void type2_inst(struct record_entry* );
-void type3_inst(struct record_entry* );
-void numval_extractor(enum ADDR_MODE , char* , int* , unsigned char* , unsigned char* , int);
-void opcode_printer(unsigned short, int, int, unsigned char);
+void load_columns(struct pass_columns* );
+void free_columns(struct pass_columns* );
+void decode_row(struct pass_columns* , unsigned );
+void encode_ranges(unsigned , unsigned , void* );
+void add_clash(struct pass_job* , unsigned , unsigned short );
+void place_row_datum(struct pass_job* , unsigned , unsigned short ,
+                     unsigned short , unsigned char );
+void place_rows(struct pass_job* );
+void list_ranges(unsigned , unsigned , void* );
+void list_row(struct pass_job* , unsigned , unsigned* , FILE* , FILE* );
+void trace_inst(struct pass_columns* , unsigned , FILE* );
+void type1_inst(struct inst_record* , struct pass_columns* , unsigned );
+void type2_inst(struct inst_record* , struct pass_columns* , unsigned );
+void type3_inst(struct jump_record* , struct pass_columns* , unsigned );
+unsigned char numval_extractor(struct record_operand* , int* , unsigned char* ,
+                               unsigned char* , int);
+void opcode_printer(FILE* , unsigned short, int, int, unsigned char);
 
 #endif /* SECONDPASS_H */
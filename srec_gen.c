@@ -6,147 +6,183 @@
 
   Coder: Elias Vonapartis, based on ECED3403 code
   Release Date: May 28, 2016
-  Latest Updates: None
+  Latest Updates: Oct 19, 2026  - The second pass fills a memory image which
+                                  is written in the formats of format_list
+                                - S-records of large images are formatted on
+                                  several threads
+                                - Hex and checksums through hexcodec.c
+                                - Record size can be raised for merged images
+                                - Image writes split from their warnings
+                                - Start address record in the .hex output
 */
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "srec_gen.h"
 #include "secondpass.h"
+#include "parallel.h"
+#include "hexcodec.h"
 
 #define SREC_DATA_SZ  32
+#define HEX_DATA_SZ   16
+#define HEX_DATA      0x00      // Record types
+#define HEX_EOF       0x01
+#define HEX_START     0x05      // Start linear address
+#define SREC_LINE_SZ  (2 + 2 + 4 + 2*SREC_MAX_DATA_SZ + 2 + 2) // '\n' and NUL
+#define HEX_LINE_SZ   (1 + 8 + 2*HEX_DATA_SZ + 2 + 1)
+#define PARALLEL_MIN_RECORDS  256   // Below this a single thread is faster
 #define HIGHBYTE(x)   ((x >> 8) & 0x00FF)
 #define LOWBYTE(x)    (x & 0x00FF)
 
-PRIVATE unsigned char srec_buffer[SREC_DATA_SZ];
+PRIVATE unsigned char srec_buffer[SREC_MAX_DATA_SZ];
+PRIVATE unsigned srec_size = SREC_DATA_SZ;  /* Data bytes per record */
 PRIVATE unsigned srec_index; /* +3 is length */
-PRIVATE unsigned srec_chksum;
 PRIVATE unsigned srec_addr;
 
+struct mem_image image;
+
+// Formats which can be requested on the command line. Only s19 by default.
+struct out_format format_list[] = {
+  {"s19", "w", write_s19},
+  {"hex", "w", write_hex},
+  {"bin", "wb", write_bin},
+  {"map", "w", write_map}
+};
+
+PRIVATE unsigned char format_selected[FMT_LAST];
+
+// Shared by the workers formatting s-records, one SREC_LINE_SZ slot per record
+struct srec_job{
+  struct srec_chunk* chunks;
+  char* text;
+  unsigned* lengths;
+};
+
+/*
+  Formats one complete S-record of the given type into line, which must hold
+  SREC_LINE_SZ chars. The length, address, data and checksum bytes are turned
+  into hex and summed by the kernels in hexcodec.c. Returns the line length.
+*/
+PRIVATE unsigned format_record(char type, unsigned short address,
+                               const unsigned char* data, unsigned length,
+                               char* line){
+  unsigned char header[3];
+  unsigned char chksum;
+  unsigned pos = 0;
+
+  /* Include len (1) and address (2) byte-pair count */
+  header[0] = length + 3;
+  header[1] = HIGHBYTE(address);
+  header[2] = LOWBYTE(address);
+
+  /* Ones-complement of the sum of every byte after the type */
+  chksum = ~(byte_sum(header, 3) + byte_sum(data, length));
+
+  line[pos++] = 'S';
+  line[pos++] = type;
+  hex_encode(header, 3, line + pos);
+  pos += 6;
+  hex_encode(data, length, line + pos);
+  pos += 2*length;
+  hex_encode(&chksum, 1, line + pos);
+  pos += 2;
+  line[pos++] = '\n';
+  line[pos] = NUL;
+  return pos;
+}
+
 void start_srec(unsigned short address){
   /*
    Initialize the srecord for output
   */
   srec_index = 0;
-  srec_chksum = 0;
   srec_addr = address;
-  srec_chksum += address & 0xff;   	   /* Least significant 16-bits */
-  srec_chksum += (address >> 8) & 0xff; /* Most significant 16-bits */
 }
 
 unsigned char write_srec(unsigned char byte){
   /*
    Write one byte to the srec_buffer[]
-   Stop if srec_index exceeds SREC_DATA_SZ
+   Stop if srec_index exceeds srec_size
    Otherwise return number of bytes remaining in buffer
   */
 
-  if(srec_index >= SREC_DATA_SZ){
+  if(srec_index >= srec_size){
     return -1;
   }
 
   srec_buffer[srec_index++] = byte;
-  srec_chksum += byte;
 
-  return (SREC_DATA_SZ - srec_index);
+  return (srec_size - srec_index);
 }
 
 void emit_srec(){
   /*
    Write S1, length, address, bytes, and chksum to s-rec file
   */
-  unsigned short len;
-  unsigned short i;
-
-  /* Include len (1) and address (2) byte-pair count */
-  len = srec_index + 3;
-
-  /* %02x - two hex digits with zero fill */
-  printf("S1%02X%04X", len, srec_addr);
-  fprintf(srec, "S1%02X%04X", len, srec_addr);
+  char line[SREC_LINE_SZ];
 
-  /* Write contents of buffer to s-rec file */
-  for (i=0; i<srec_index; i++){
-    printf("%02X", srec_buffer[i]);
-  	fprintf(srec, "%02X", srec_buffer[i]);
-  }
-
-  /* Include length in checksum */
-  srec_chksum += len;
-
-  /* Write ones-complement of checksum - note suppression of sign extension */
-  printf("%02X\n", (~srec_chksum) & 0xff);
-  fprintf(srec, "%02X\n", (~srec_chksum) & 0xff);
+  format_record('1', srec_addr, srec_buffer, srec_index, line);
+  fputs(line, srec);
 }
 
 void emit_s9(unsigned short address){
   /*
-   Write S1, length, address, bytes, and chksum to s-rec file
+   Write S9, length, address and chksum to s-rec file
   */
-  int len;
-  unsigned char chksum = 0;
-
-  /* Include cksum (1) and address (2) byte-pair count */
-  len = 3;
-
-  /* %02x - two hex digits with zero fill */
-  fprintf(srec,"S9%02X%04X", len, address);
-
-  /*include length in checcksum*/
-  chksum += len;
-  chksum += address & 0xff;          /*Least significant 16-bits*/
-  chksum += (address >> 8) & 0xff;   /*Most significan 16-bits*/
+  char line[SREC_LINE_SZ];
 
-  /*write ones-complement of checksum - note suppresion of sign extension*/
-  fprintf(srec,"%02X\n", (~chksum) & 0xff);
+  format_record('9', address, NULL, 0, line);
+  fputs(line, srec);
 }
 
 
 /*
-  This function makes use of the provided code to generate the srecords in
-  little endian format if necessary. It takes the a word sized argument, the
-  LC pointing to it and whether the data is a byte or word.
+  This function writes a word or a byte into the memory image in little endian
+  format if necessary. It takes the a word sized argument, the LC pointing to it
+  and whether the data is a byte or word. Writing over an address which already
+  holds code or data is reported as a warning.
 */
 
 void srec_gen(unsigned short datum, unsigned short location, unsigned char bw){
-  unsigned char low_byte;
-  unsigned char high_byte;
-  unsigned short buff_space;
-
-  printf("\nemit_srec\n");
-  printf("emitting datum: %04x\n", datum);
-
-  low_byte = LOWBYTE(datum);
-  buff_space = write_srec(low_byte);
-  printf("buff_space_byte %d\n", buff_space);
-  if(buff_space == 0){
-    emit_srec();
-    start_srec(location + 1);
-  }
-
-  if(bw == WORDSIZE){
-    high_byte = HIGHBYTE(datum);
-    buff_space = write_srec(high_byte);
-    printf("buff_space %d\n", buff_space);
-    printf("high_byte %02x\n", high_byte);
-    printf("low_byte %02x\n", low_byte);
-
-    /*
-      We check to see if the buffer is full. We only need to check for == 0 due
-      to the addition of one byte at a time. If the record has reached its max
-      value we produce it and start a new one.
-    */
-    if(buff_space == 0){
-      emit_srec();
-      start_srec(location + 2);
+  unsigned char clashes;
+  unsigned short i;
+
+  #ifdef debug
+  printf("emitting datum: %04x at %04x\n", datum, location);
+  #endif /* debug */
+
+  clashes = place_datum(datum, location, bw);
+  for(i = 0; clashes; i++, clashes >>= 1){
+    if(clashes & 1){
+      fprintf(fout, "WARNING: Address %04x is written more than once\n",
+              (unsigned short)(location + i));
     }
   }
-  
-  return;
+}
+
+/*
+  Writes a word or byte datum to the image without any output. Returns a bit
+  per byte, bit 0 for the low byte, set where the address was already written,
+  which the caller has to report.
+*/
+unsigned char place_datum(unsigned short datum, unsigned short location,
+                          unsigned char bw){
+  unsigned short i;
+  unsigned short count = (bw == WORDSIZE) ? 2 : 1;
+  unsigned short address;
+  unsigned char clashes = 0;
+
+  for(i = 0; i < count; i++){
+    address = location + i;
+    clashes |= image.used[address] << i;
+    image.data[address] = (i == 0) ? LOWBYTE(datum) : HIGHBYTE(datum);
+    image.used[address] = TRUE;
+  }
+  return clashes;
 }
 
 void srec_char(char* datum, unsigned short location){
-  unsigned short buff_space;
   unsigned short i = 0;
 
   // The following is to avoid any crashes. This message should never appear
@@ -154,32 +190,264 @@ void srec_char(char* datum, unsigned short location){
     fprintf(fout, "ERROR: Attempting to write an empty string to srec\n");
     return;
   }
-  // Add each char to string seperately
+  // Add each char to the image seperately
   while(datum[i]){
-    buff_space = write_srec(datum[i]);
-    if(buff_space == 0){
-      emit_srec();
-      start_srec(location + i);
-    }
+    srec_gen(datum[i], location + i, BYTESIZE);
     i++;
   }
 }
 
-void srec_org(unsigned short address){
-  emit_srec();                  //emits the current s-rec
-  start_srec(address);          //starts an new one at the address specified
+/* Empties the image before a second pass */
+void clear_image(void){
+  free(image.symbols);
+  memset(&image, 0, sizeof(image));
 }
 
-void srec_bss(unsigned short length, unsigned short location){
-  unsigned short buff_space;
-  unsigned short i = 0;
+/*
+  Marks the format named by the command line argument for output. Returns FALSE
+  if no format has that name.
+*/
+unsigned char select_format(char* name){
+  unsigned short i;
+
+  for(i = 0; i < FMT_LAST; i++){
+    if(strcasecmp(name, format_list[i].ext) == 0){
+      format_selected[i] = TRUE;
+      return TRUE;
+    }
+  }
+  return FALSE;
+}
+
+/*
+  Sets the data bytes per S1 record, up to SREC_MAX_DATA_SZ. The assembler keeps
+  SREC_DATA_SZ, the merge subcommand packs records to the maximum.
+*/
+void set_record_size(unsigned size){
+  srec_size = (size > SREC_MAX_DATA_SZ || size == 0) ? SREC_MAX_DATA_SZ : size;
+}
+
+/* Returns the format whose extension ends the file name, s19 if none does */
+enum OUT_FORMAT format_for_name(const char* name){
+  const char* ext = strrchr(name, '.');
+  unsigned short i;
 
-  while(length - i){
-    buff_space = write_srec('0');   // Save space by writing char '\0'
-    if(buff_space == 0){
+  for(i = 0; ext && i < FMT_LAST; i++){
+    if(strcasecmp(ext + 1, format_list[i].ext) == 0){
+      return i;
+    }
+  }
+  return FMT_S19;
+}
+
+/*
+  Writes the image in one format to the named file. The file being written is
+  kept in srec for the duration of its writer. Returns FALSE if it cannot be
+  opened.
+*/
+unsigned char write_format(enum OUT_FORMAT format, const char* name){
+  if((srec = fopen(name, format_list[format].mode)) == NULL){
+    return FALSE;
+  }
+  format_list[format].writer();
+  fclose(srec);
+  srec = NULL;
+  return TRUE;
+}
+
+/* Writes every format selected on the command line from the image */
+void write_outputs(void){
+  char name[LINE_LEN];
+  unsigned short i;
+  unsigned char any = FALSE;
+
+  for(i = 0; i < FMT_LAST; i++){
+    any |= format_selected[i];
+  }
+  if(!any){
+    format_selected[FMT_S19] = TRUE;
+  }
+
+  for(i = 0; i < FMT_LAST; i++){
+    if(!format_selected[i]){
+      continue;
+    }
+    sprintf(name, "%s.%s", OUTPUT_NAME, format_list[i].ext);
+    if(!write_format(i, name)){
+      fprintf(fout, "ERROR: Output file %s could not be opened\n", name);
+    }
+  }
+}
+
+/*
+  Splits each contiguous run of written bytes in the image into records of at
+  most srec_size bytes. Returns the number of records, the caller owns the
+  list.
+*/
+unsigned collect_records(struct srec_chunk** list){
+  unsigned address = 0;
+  unsigned count = 0;
+  struct srec_chunk* chunks;
+
+  // Worst case is every other byte written, one record each
+  chunks = malloc(sizeof(struct srec_chunk)*(IMAGE_SZ/2));
+
+  while(address < IMAGE_SZ){
+    if(!image.used[address]){
+      address++;
+      continue;
+    }
+    chunks[count].address = address;
+    chunks[count].length = 0;
+    do{
+      chunks[count].length++;
+      address++;
+    }while(chunks[count].length < srec_size && address < IMAGE_SZ &&
+           image.used[address]);
+    count++;
+  }
+  *list = chunks;
+  return count;
+}
+
+/*
+  Formats one S1 record for the given chunk of the image into line, which must
+  hold SREC_LINE_SZ chars. Returns the length of the line. Only reads the image
+  so any number of records can be formatted at once.
+*/
+unsigned format_srec(struct srec_chunk* chunk, char* line){
+  return format_record('1', chunk->address, image.data + chunk->address,
+                       chunk->length, line);
+}
+
+/* Worker for write_s19(), formats its range of records into their slots */
+PRIVATE void format_range(unsigned begin, unsigned end, void* arg){
+  struct srec_job* job = arg;
+  unsigned i;
+
+  for(i = begin; i < end; i++){
+    job->lengths[i] = format_srec(&job->chunks[i], job->text + i*SREC_LINE_SZ);
+  }
+}
+
+/*
+  Writes the image as S1 records followed by the S9 record with the starting
+  address. Every record depends only on its own bytes, so large images are
+  formatted on several threads into one slot per record and written in order.
+  Small images go through emit_srec() one record at a time, which produces the
+  same output.
+*/
+void write_s19(void){
+  struct srec_chunk* chunks;
+  struct srec_job job;
+  unsigned count;
+  unsigned i;
+  unsigned short j;
+
+  count = collect_records(&chunks);
+
+  if(count >= PARALLEL_MIN_RECORDS && thread_count() > 1){
+    job.chunks = chunks;
+    job.text = malloc(count*SREC_LINE_SZ);
+    job.lengths = malloc(sizeof(unsigned)*count);
+    parallel_for(count, PARALLEL_MIN_RECORDS/2, format_range, &job);
+    for(i = 0; i < count; i++){
+      fwrite(job.text + i*SREC_LINE_SZ, 1, job.lengths[i], srec);
+    }
+    free(job.text);
+    free(job.lengths);
+  }
+  else{
+    for(i = 0; i < count; i++){
+      start_srec(chunks[i].address);
+      for(j = 0; j < chunks[i].length; j++){
+        write_srec(image.data[chunks[i].address + j]);
+      }
       emit_srec();
-      start_srec(location + i);
     }
-    i++;
+  }
+  free(chunks);
+  emit_s9(image.start);
+}
+
+/* Writes one Intel HEX record of the given type to the output file */
+PRIVATE void hex_record(unsigned char type, unsigned short address,
+                        const unsigned char* data, unsigned char count){
+  char line[HEX_LINE_SZ];
+  unsigned char header[4];
+  unsigned char chksum;
+
+  header[0] = count;
+  header[1] = HIGHBYTE(address);
+  header[2] = LOWBYTE(address);
+  header[3] = type;
+  chksum = -(byte_sum(header, 4) + byte_sum(data, count));
+
+  line[0] = ':';
+  hex_encode(header, 4, line + 1);
+  hex_encode(data, count, line + 9);
+  hex_encode(&chksum, 1, line + 9 + 2*count);
+  line[11 + 2*count] = '\n';
+  fwrite(line, 1, 12 + 2*count, srec);
+}
+
+/*
+  Intel HEX, 16 data bytes per type 00 record, then a type 05 record with the
+  starting address, as the S9 record of an .s19 has it, and a type 01 end of
+  file.
+*/
+void write_hex(void){
+  unsigned char start[4];
+  unsigned address = 0;
+  unsigned char count;
+
+  while(address < IMAGE_SZ){
+    if(!image.used[address]){
+      address++;
+      continue;
+    }
+    for(count = 0; count < HEX_DATA_SZ && (address + count) < IMAGE_SZ &&
+                   image.used[address + count]; count++);
+
+    hex_record(HEX_DATA, address, image.data + address, count);
+    address += count;
+  }
+
+  start[0] = 0;                     // 32 bit linear address, high word 0
+  start[1] = 0;
+  start[2] = HIGHBYTE(image.start);
+  start[3] = LOWBYTE(image.start);
+  hex_record(HEX_START, 0, start, 4);
+  hex_record(HEX_EOF, 0, NULL, 0);
+}
+
+/* Raw image from the lowest to the highest written address */
+void write_bin(void){
+  int first = -1;
+  int last = -1;
+  int address;
+
+  for(address = 0; address < IMAGE_SZ; address++){
+    if(image.used[address]){
+      if(first < 0){
+        first = address;
+      }
+      last = address;
+    }
+  }
+
+  for(address = first; first >= 0 && address <= last; address++){
+    fputc(image.used[address] ? image.data[address] : BIN_FILL, srec);
+  }
+}
+
+/* Symbol map from the snapshot taken at the end of the second pass */
+void write_map(void){
+  unsigned i;
+
+  fprintf(srec, "Start: %04X\n\n", image.start);
+  for(i = 0; i < image.symbol_count; i++){
+    fprintf(srec, "%04X  %s\n", image.symbols[i].value & 0xFFFF,
+            image.symbols[i].name);
   }
 }
@@ -8,23 +8,70 @@
 
   Coder: Code from ECED3403 with additions by Elias Vonapartis
   Release Date: May 28, 2016
-  Latest Updates: None
+  Latest Updates: Oct 19, 2026  - Added the memory image and format writers
+                                - Image writes without output for the passes
 */
 
+#include "symboltable.h"
+
 /* Definitions */
 #define PRIVATE static
 
+#define IMAGE_SZ      65536     // Full 16-bit MSP430 address space
+#define SREC_MAX_DATA_SZ  252   // Largest S1 record, count byte of 255
+#define OUTPUT_NAME   "srecords"
+#define BIN_FILL      0xFF      // Value of unwritten bytes in a .bin (erased)
+
+/*
+  The second pass writes every byte of code and data into this image instead of
+  straight into an s-record file. Once it is complete any number of output
+  formats can be written from it.
+*/
+struct mem_image{
+  unsigned char data[IMAGE_SZ];
+  unsigned char used[IMAGE_SZ];   // TRUE where a byte has been written
+  unsigned short start;           // Starting address from the END directive
+  struct symbol_entry* symbols;   // Snapshot of the labels, sorted by value
+  unsigned symbol_count;
+};
+
+enum OUT_FORMAT {FMT_S19, FMT_HEX, FMT_BIN, FMT_MAP, FMT_LAST};
+
+/* One S1 record worth of the image */
+struct srec_chunk{
+  unsigned short address;
+  unsigned char length;
+};
+
+struct out_format{
+  char *ext;              // Extension of the output file, also its CLI name
+  char *mode;             // fopen() mode
+  void (*writer)(void);   // Writes the image to the file opened in srec
+};
+
 /* Data Declarations */
 extern FILE *srec;
+extern struct mem_image image;
 
 /* Function Declarations */
 void start_srec(unsigned short);
 unsigned char write_srec(unsigned char);
 void emit_srec(void);
 void srec_gen(unsigned short, unsigned short, unsigned char );
+unsigned char place_datum(unsigned short , unsigned short , unsigned char );
 void emit_s9(unsigned short );
 void srec_char(char* , unsigned short );
-void srec_org(unsigned short);
-void srec_bss(unsigned short, unsigned short);
+void clear_image(void);
+unsigned char select_format(char* );
+void set_record_size(unsigned );
+enum OUT_FORMAT format_for_name(const char* );
+unsigned char write_format(enum OUT_FORMAT , const char* );
+void write_outputs(void);
+unsigned collect_records(struct srec_chunk** );
+unsigned format_srec(struct srec_chunk* , char* );
+void write_s19(void);
+void write_hex(void);
+void write_bin(void);
+void write_map(void);
 
 #endif /* SREC_GEN_H */
@@ -0,0 +1,417 @@
+/*
+  srec_load.c
+  Loader for s-record files and the verify and merge subcommands. The file is
+  mapped into memory and every record is decoded with the kernels in
+  hexcodec.c, checking its length, checksum and address before its data goes
+  into a memory image.
+
+  Coder: Elias Vonapartis
+  Release Date: Oct 19, 2026
+  Latest Updates: Oct 19, 2026  - Added the merge subcommand
+                                - Length of the S5 and S6 records checked
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "assembler.h"
+#include "parser.h"
+#include "srec_load.h"
+#include "hexcodec.h"
+
+#define SREC_MAX_BYTES  256     // Count byte plus up to 255 more
+
+PRIVATE const char* load_name;
+PRIVATE unsigned load_line;
+
+/* Prints a problem found in the file being loaded, up to MAX_REPORTED */
+PRIVATE void load_error(struct load_report* report, const char* message,
+                        unsigned value){
+  if(report->errors++ < MAX_REPORTED){
+    printf("%s:%u: ", load_name, load_line);
+    printf(message, value);
+    printf("\n");
+  }
+}
+
+/*
+  Bytes in the address field of each record type, 0 for none. The record
+  count of an S5 or S6 takes the place of the address.
+*/
+PRIVATE unsigned char address_width(char type){
+  switch (type) {
+    case '1':
+    case '5':
+    case '9':
+    return 2;
+    case '2':
+    case '6':
+    case '8':
+    return 3;
+    case '3':
+    case '7':
+    return 4;
+    default:
+    return 0;
+  }
+}
+
+/* Checks one record and stores its data in the image */
+PRIVATE void load_record(const char* line, unsigned length,
+                         struct mem_image* img, struct load_report* report){
+  unsigned char bytes[SREC_MAX_BYTES];
+  unsigned count;
+  unsigned width;
+  unsigned address = 0;
+  unsigned data_len;
+  unsigned i;
+  unsigned char overlapped = FALSE;
+
+  if(length < 4 || line[0] != 'S' || (length % 2)){
+    load_error(report, "ERROR: Not an s-record", 0);
+    return;
+  }
+  count = (length - 2)/2;
+  if(count > SREC_MAX_BYTES || !hex_decode(line + 2, count, bytes)){
+    load_error(report, "ERROR: Invalid hex digits or record too long", 0);
+    return;
+  }
+  if(bytes[0] != count - 1){
+    load_error(report, "ERROR: Length byte does not match the %u bytes "
+               "in the record", count - 1);
+    return;
+  }
+  if((byte_sum(bytes, count) & 0xFF) != 0xFF){
+    load_error(report, "ERROR: Checksum mismatch, expected %02X",
+               ~byte_sum(bytes, count - 1) & 0xFF);
+    return;
+  }
+  if(report->terminated){
+    load_error(report, "ERROR: Record after the termination record", 0);
+    return;
+  }
+
+  width = address_width(line[1]);
+  if(count < width + 2){
+    load_error(report, "ERROR: Record too short for its address", 0);
+    return;
+  }
+  if((line[1] == '5' || line[1] == '6') && count != width + 2){
+    load_error(report, "ERROR: Record count of S%c has the wrong length",
+               line[1]);
+    return;
+  }
+  for(i = 0; i < width; i++){
+    address = (address << 8) | bytes[1 + i];
+  }
+
+  switch (line[1]) {
+    case '0':                         // Header, contents are free form
+    break;
+    case '1':
+    case '2':
+    case '3':
+    data_len = count - width - 2;
+    if(address + data_len > IMAGE_SZ){
+      load_error(report, "ERROR: Data at %X is outside the 16-bit image",
+                 address);
+      return;
+    }
+    for(i = 0; i < data_len; i++){
+      if(img->used[address + i] && !overlapped){
+        overlapped = TRUE;
+        if(report->overlaps < MAX_REPORTED){
+          printf("%s:%u: ERROR: Address %04X is already written\n", load_name,
+                 load_line, address + i);
+        }
+      }
+      report->overlaps += img->used[address + i];
+      img->used[address + i] = TRUE;
+    }
+    memcpy(img->data + address, bytes + 1 + width, data_len);
+    report->records++;
+    report->bytes += data_len;
+    break;
+    case '5':
+    case '6':
+    if(address != (report->records & ((1u << 8*width) - 1))){
+      load_error(report, "ERROR: Record count does not match the %u data "
+                 "records", report->records);
+    }
+    break;
+    case '7':
+    case '8':
+    case '9':
+    report->terminated = TRUE;
+    report->start = address;
+    img->start = address;
+    break;
+    default:
+    load_error(report, "ERROR: Unknown record type S%c", line[1]);
+    break;
+  }
+}
+
+/*
+  Maps the named file and loads every record into img, which is not cleared so
+  several files can be loaded into one image. Returns FALSE if the file cannot
+  be read, the problems found in it are counted in report.
+*/
+unsigned char load_srec(const char* name, struct mem_image* img,
+                        struct load_report* report){
+  struct stat info;
+  const char* text;
+  const char* line;
+  const char* end;
+  const char* eol;
+  unsigned length;
+  int fd;
+
+  memset(report, 0, sizeof(struct load_report));
+  load_name = name;
+  load_line = 0;
+
+  if((fd = open(name, O_RDONLY)) < 0 || fstat(fd, &info) < 0){
+    printf("File %s could not be opened\n", name);
+    if(fd >= 0){
+      close(fd);
+    }
+    return FALSE;
+  }
+  if(info.st_size == 0){
+    load_error(report, "ERROR: Empty file", 0);
+    close(fd);
+    return TRUE;
+  }
+  text = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if(text == MAP_FAILED){
+    printf("File %s could not be mapped\n", name);
+    close(fd);
+    return FALSE;
+  }
+  madvise((void* )text, info.st_size, MADV_SEQUENTIAL);
+
+  end = text + info.st_size;
+  for(line = text; line < end; line = eol + 1){
+    load_line++;
+    if((eol = memchr(line, '\n', end - line)) == NULL){
+      eol = end;
+    }
+    length = eol - line;
+    if(length && line[length - 1] == '\r'){
+      length--;
+    }
+    if(length){                       // Blank lines are tolerated
+      load_record(line, length, img, report);
+    }
+  }
+
+  if(!report->terminated){
+    load_error(report, "ERROR: Missing termination record", 0);
+  }
+  munmap((void* )text, info.st_size);
+  close(fd);
+  return TRUE;
+}
+
+/* Compares the loaded image with a raw binary starting at its lowest address */
+PRIVATE unsigned compare_bin(const struct mem_image* img, const char* name){
+  FILE* bin;
+  unsigned first;
+  unsigned address;
+  unsigned mismatches = 0;
+  int byte;
+
+  if((bin = fopen(name, "rb")) == NULL){
+    printf("File %s could not be opened\n", name);
+    return 1;
+  }
+  for(first = 0; first < IMAGE_SZ && !img->used[first]; first++);
+
+  for(address = first; (byte = fgetc(bin)) != EOF; address++){
+    if(address >= IMAGE_SZ ||
+       byte != (img->used[address] ? img->data[address] : BIN_FILL)){
+      if(mismatches++ < MAX_REPORTED){
+        printf("MISMATCH: %04X binary %02X s-record %02X\n", address, byte,
+               (address < IMAGE_SZ && img->used[address]) ?
+               img->data[address] : BIN_FILL);
+      }
+    }
+  }
+  for(; address < IMAGE_SZ; address++){
+    if(img->used[address] && mismatches++ < MAX_REPORTED){
+      printf("MISMATCH: %04X is past the end of the binary\n", address);
+    }
+  }
+  fclose(bin);
+  return mismatches;
+}
+
+/* Compares the loaded image with the image of a fresh assembly */
+PRIVATE unsigned compare_asm(const struct mem_image* img, const char* name){
+  unsigned address;
+  unsigned mismatches = 0;
+
+  if(!assemble(name)){
+    printf("Assembly of %s failed, see diagnostics.lis\n", name);
+    terminate();
+    return 1;
+  }
+  for(address = 0; address < IMAGE_SZ; address++){
+    if(img->used[address] != image.used[address] ||
+       (img->used[address] && img->data[address] != image.data[address])){
+      if(mismatches++ < MAX_REPORTED){
+        printf("MISMATCH: %04X assembly %02X%s s-record %02X%s\n", address,
+               image.data[address], image.used[address] ? "" : " (unused)",
+               img->data[address], img->used[address] ? "" : " (unused)");
+      }
+    }
+  }
+  if(img->start != image.start){
+    mismatches++;
+    printf("MISMATCH: Start address assembly %04X s-record %04X\n",
+           image.start, img->start);
+  }
+  terminate();
+  return mismatches;
+}
+
+/*
+  ./assembler verify file.s19 [bin file.bin | asm file.asm]
+  Checks every record of the file and optionally compares the image it holds
+  with a binary or with a fresh assembly. Returns the process exit status.
+*/
+int verify_command(int argc, char const *argv[]){
+  struct mem_image* img;
+  struct load_report report;
+  unsigned mismatches = 0;
+
+  if(argc != 3 && !(argc == 5 && (strcmp(argv[3], "bin") == 0 ||
+                                  strcmp(argv[3], "asm") == 0))){
+    printf("Format: ./assembler verify 'file.s19' [bin 'file.bin' | "
+           "asm 'file.asm']\n");
+    return 2;
+  }
+
+  img = calloc(1, sizeof(struct mem_image));
+  if(!load_srec(argv[2], img, &report)){
+    free(img);
+    return 2;
+  }
+  printf("%s: %u data records, %u bytes, start %04X\n", argv[2],
+         report.records, report.bytes, report.start);
+  if(report.overlaps){
+    printf("%s: %u bytes written more than once\n", argv[2], report.overlaps);
+  }
+
+  if(argc == 5){
+    mismatches = (argv[3][0] == 'b') ? compare_bin(img, argv[4]) :
+                                       compare_asm(img, argv[4]);
+    printf("%u mismatches against %s\n", mismatches, argv[4]);
+  }
+  free(img);
+
+  if(report.errors || report.overlaps || mismatches){
+    printf("VERIFY FAILED\n");
+    return 1;
+  }
+  printf("VERIFY PASSED\n");
+  return 0;
+}
+
+/*
+  Copies the bytes of one loaded input into the merged image. A byte already
+  owned by an earlier input is a conflict, an error when the data differs. The
+  input owning each byte is kept in owner, numbered from 1.
+*/
+PRIVATE unsigned merge_image(const struct mem_image* input, unsigned short id,
+                             unsigned short* owner, char const *names[],
+                             unsigned* conflicts){
+  unsigned address;
+  unsigned errors = 0;
+  unsigned char differs;
+
+  for(address = 0; address < IMAGE_SZ; address++){
+    if(!input->used[address]){
+      continue;
+    }
+    if(image.used[address]){
+      differs = (image.data[address] != input->data[address]);
+      errors += differs;
+      if((*conflicts)++ < MAX_REPORTED){
+        printf("%s: %s %04X also written by %s%s\n", names[id],
+               differs ? "ERROR: Address" : "WARNING: Address", address,
+               names[owner[address]], differs ? " with different data" : "");
+      }
+      continue;
+    }
+    image.data[address] = input->data[address];
+    image.used[address] = TRUE;
+    owner[address] = id;
+  }
+  return errors;
+}
+
+/*
+  ./assembler merge out.s19 in1.s19 in2.s19 ...
+  Loads every input into one image and writes it repacked into records of the
+  largest size, in the format given by the extension of the output file. The
+  starting address is taken from the first input. Nothing is written if any
+  input has errors or two inputs disagree on a byte.
+*/
+int merge_command(int argc, char const *argv[]){
+  struct mem_image* input;
+  struct load_report report;
+  unsigned short* owner;
+  unsigned conflicts = 0;
+  unsigned errors = 0;
+  unsigned short id;
+
+  if(argc < 4){
+    printf("Format: ./assembler merge 'out.s19' 'in.s19' ['in.s19' ...]\n");
+    return 2;
+  }
+  if(argc - 3 >= USHRT_MAX){
+    printf("Too many inputs to merge\n");
+    return 2;
+  }
+
+  input = malloc(sizeof(struct mem_image));
+  owner = calloc(IMAGE_SZ, sizeof(unsigned short));
+  clear_image();
+
+  // argv[3] is input 1 and so on, owner numbers index argv from 2
+  for(id = 1; id < argc - 2; id++){
+    memset(input->used, FALSE, IMAGE_SZ);
+    if(!load_srec(argv[id + 2], input, &report)){
+      errors++;
+      continue;
+    }
+    if(id == 1){
+      image.start = report.start;
+    }
+    errors += report.errors + report.overlaps;
+    errors += merge_image(input, id, owner, argv + 2, &conflicts);
+  }
+  free(input);
+  free(owner);
+
+  printf("%d inputs merged, %u conflicting bytes\n", argc - 3, conflicts);
+  if(errors){
+    printf("MERGE FAILED, %s not written\n", argv[2]);
+    return 1;
+  }
+
+  set_record_size(SREC_MAX_DATA_SZ);
+  if(!write_format(format_for_name(argv[2]), argv[2])){
+    printf("Output file %s could not be opened\n", argv[2]);
+    return 1;
+  }
+  printf("MERGED into %s\n", argv[2]);
+  return 0;
+}
@@ -0,0 +1,32 @@
+#ifndef SREC_LOAD_H
+#define SREC_LOAD_H
+
+/*
+  srec_load.h
+  Header file for srec_load.c
+
+  Coder: Elias Vonapartis
+  Release Date: Oct 19, 2026
+  Latest Updates: Oct 19, 2026  - Added merge_command()
+*/
+
+#include "srec_gen.h"
+
+#define MAX_REPORTED  10      // Problems of one kind printed per file
+
+/* Totals gathered while loading one s-record file */
+struct load_report{
+  unsigned records;       // Data records
+  unsigned bytes;         // Data bytes
+  unsigned errors;        // Format, checksum and termination problems
+  unsigned overlaps;      // Data bytes landing on an already written address
+  unsigned char terminated;
+  unsigned start;         // Address in the termination record
+};
+
+/* Function Declarations */
+unsigned char load_srec(const char* , struct mem_image* , struct load_report* );
+int verify_command(int , char const *[]);
+int merge_command(int , char const *[]);
+
+#endif /* SREC_LOAD_H */
@@ -6,59 +6,259 @@
 
   Coder: Elias Vonapartis
   Release Date: May 28, 2016
-  Latest Updates: None
+  Latest Updates: Oct 19, 2026  - Concurrent hash table replaces the list
+                                - Registers in a constant table of their own
+                                - Symbols numbered with dense IDs
+                                - Fixup lists resolved on definition
 */
 
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <ctype.h>
+#include <stdatomic.h>
 #include "symboltable.h"
 #include "parser.h"
 #include "errors.h"
+#include "records.h"
 
-/* Symbol table list pointer - iunitially list is empty */
-struct symbol_entry *entry = NULL;
-
-void init_symboltable(void){
-  /*
-   - Initialize the symbol table with register values
-   - Treat registers as labels with type of REGTYPE
-  */
-  add_entry("R0",  0,  REGTYPE);
-  add_entry("PC",  0,  REGTYPE); /* Alias for R0 */
-  add_entry("R1",  1,  REGTYPE);
-  add_entry("SP",  1,  REGTYPE); /* Alias for R1 */
-  add_entry("R2",  2,  REGTYPE);
-  add_entry("SR",  2,  REGTYPE); /* Alias for R2 */
-  add_entry("R3",  3,  REGTYPE);
-  add_entry("R4",  4,  REGTYPE);
-  add_entry("R5",  5,  REGTYPE);
-  add_entry("R6",  6,  REGTYPE);
-  add_entry("R7",  7,  REGTYPE);
-  add_entry("R8",  8,  REGTYPE);
-  add_entry("R9",  9,  REGTYPE);
-  add_entry("R10", 10, REGTYPE);
-  add_entry("R11", 11, REGTYPE);
-  add_entry("R12", 12, REGTYPE);
-  add_entry("R13", 13, REGTYPE);
-  add_entry("R14", 14, REGTYPE);
-  add_entry("R15", 15, REGTYPE);
-  return;
+/*
+  The symbol table is a fixed array of buckets, each the head of a chain of
+  entries. Entries are pushed onto a chain with a compare and swap once fully
+  built and are never unlinked while assembling, so lookups need no locks and
+  any number of threads may insert at once.
+*/
+static _Atomic(struct symbol_entry*) buckets[SYMBOL_BUCKETS];
+static atomic_uint symbol_total;
+
+/*
+  Entries by ID. IDs are handed out in order starting after the registers,
+  which keep the IDs of their table slots. The array is split in chunks that
+  are allocated as the IDs reach them and never move, so an ID is turned into
+  its entry by indexing while other threads are inserting.
+*/
+typedef _Atomic(struct symbol_entry*) symbol_slot;
+
+static _Atomic(symbol_slot*) id_chunks[SYMBOL_CHUNKS];
+static atomic_uint next_id = REG_COUNT + REG_ALIASES;
+
+/* Every symbol that ever had a fixup, linked through pending */
+static _Atomic(struct symbol_entry*) pending_symbols;
+
+/*
+  Registers are treated as labels with type of REGTYPE. They live in this
+  read only table rather than in the buckets, so nothing is allocated for them
+  and register_entry() finds them without hashing. The aliases follow R15.
+*/
+static const struct symbol_entry registers[REG_COUNT + REG_ALIASES] = {
+  {"R0",   0, REGTYPE, TRUE, 0,  0},
+  {"R1",   1, REGTYPE, TRUE, 0,  1},
+  {"R2",   2, REGTYPE, TRUE, 0,  2},
+  {"R3",   3, REGTYPE, TRUE, 0,  3},
+  {"R4",   4, REGTYPE, TRUE, 0,  4},
+  {"R5",   5, REGTYPE, TRUE, 0,  5},
+  {"R6",   6, REGTYPE, TRUE, 0,  6},
+  {"R7",   7, REGTYPE, TRUE, 0,  7},
+  {"R8",   8, REGTYPE, TRUE, 0,  8},
+  {"R9",   9, REGTYPE, TRUE, 0,  9},
+  {"R10", 10, REGTYPE, TRUE, 0, 10},
+  {"R11", 11, REGTYPE, TRUE, 0, 11},
+  {"R12", 12, REGTYPE, TRUE, 0, 12},
+  {"R13", 13, REGTYPE, TRUE, 0, 13},
+  {"R14", 14, REGTYPE, TRUE, 0, 14},
+  {"R15", 15, REGTYPE, TRUE, 0, 15},
+  {"PC",   0, REGTYPE, TRUE, 0, 16},       /* Alias for R0 */
+  {"SP",   1, REGTYPE, TRUE, 0, 17},       /* Alias for R1 */
+  {"SR",   2, REGTYPE, TRUE, 0, 18}        /* Alias for R2 */
+};
+
+/*
+  Returns the number of the register named by the first length characters of
+  name, or NO_REG. Accepts R0 to R15 and the aliases PC, SP and SR.
+*/
+int register_number(const char* name, unsigned length){
+  int number;
+
+  if(length == 2 && name[1] == 'C' && name[0] == 'P'){
+    return 0;
+  }
+  if(length == 2 && name[1] == 'P' && name[0] == 'S'){
+    return 1;
+  }
+  if(length == 2 && name[1] == 'R' && name[0] == 'S'){
+    return 2;
+  }
+  if(name[0] != 'R' || length < 2 || length > REG_SIZE || !isdigit(name[1])){
+    return NO_REG;
+  }
+  if(length == 2){
+    return name[1] - '0';
+  }
+  if(name[1] != '1' || !isdigit(name[2])){  // Only R10 to R15 have two digits
+    return NO_REG;
+  }
+  number = 10 + name[2] - '0';
+  return number <= 15 ? number : NO_REG;
+}
+
+/* Entry of the register or alias called name, NULL if name is not one */
+const struct symbol_entry* register_entry(const char* name){
+  unsigned length;
+  int number;
+
+  if(name[0] == NUL || name[1] == NUL){
+    return NULL;
+  }
+  length = (name[2] == NUL) ? 2 : (name[3] == NUL) ? 3 : 0;
+  if(length == 0 || (number = register_number(name, length)) == NO_REG){
+    return NULL;
+  }
+  return &registers[(name[0] == 'R') ? number : REG_COUNT + number];
+}
+
+/* FNV-1a hash of a symbol name, names are case sensitive */
+unsigned hash_name(const char* name){
+  unsigned hash = 2166136261u;
+
+  while(*name){
+    hash = (hash ^ (unsigned char)*name++) * 16777619u;
+  }
+  return hash;
+}
+
+/* Slot of the given ID in the ID chunks, allocating its chunk if needed */
+static symbol_slot* id_slot(unsigned id){
+  symbol_slot* chunk;
+  symbol_slot* newchunk;
+  _Atomic(symbol_slot*)* chunkptr = &id_chunks[id / SYMBOL_CHUNK];
+
+  if(!(chunk = atomic_load_explicit(chunkptr, memory_order_acquire))){
+    newchunk = calloc(SYMBOL_CHUNK, sizeof(symbol_slot));
+    if(atomic_compare_exchange_strong(chunkptr, &chunk, newchunk)){
+      chunk = newchunk;
+    }
+    else{
+      free(newchunk);               // Another thread allocated it first
+    }
+  }
+  return &chunk[id % SYMBOL_CHUNK];
 }
 
 /*
-  Assumes the entry is unique (caller must do a get_entry() beforehand
-  Adds new entry to end of list
+  Entry of a symbol ID, NULL if the ID was never given out. The entries of
+  registers must not be written to.
+*/
+struct symbol_entry* symbol_by_id(unsigned id){
+  symbol_slot* chunk;
+
+  if(id < REG_COUNT + REG_ALIASES){
+    return (struct symbol_entry*)&registers[id];
+  }
+  if(id >= SYMBOL_CHUNK*SYMBOL_CHUNKS ||
+     !(chunk = atomic_load_explicit(&id_chunks[id / SYMBOL_CHUNK],
+                                    memory_order_acquire))){
+    return NULL;
+  }
+  return atomic_load_explicit(&chunk[id % SYMBOL_CHUNK], memory_order_acquire);
+}
+
+/* IDs given out so far are below this one */
+unsigned symbol_limit(void){
+  return atomic_load(&next_id);
+}
+
+/* Name of a symbol ID, for listings */
+const char* symbol_name(unsigned id){
+  struct symbol_entry* entry = symbol_by_id(id);
+
+  return entry ? entry->name : "-";
+}
+
+/* Searches one chain, starting at the entry which was its head */
+static struct symbol_entry* find_in_chain(struct symbol_entry* stptr,
+                                          const char* name, unsigned hash){
+  while(stptr){
+    if(stptr->hash == hash && strcmp(stptr->name, name) == 0){
+      return stptr;
+    }
+    stptr = stptr->next;
+  }
+  return NULL;
+}
+
+/*
+  Returns the entry of name, adding it with value and type if there is none.
+  inserted tells which happened. When two threads insert the same name the
+  compare and swap lets only one of them in, the other retries, finds the
+  winner's entry and discards its own. Register names are never added, their
+  read only entry is returned. A new entry takes the next ID and is placed in
+  its ID slot before it can be found by name, so anyone holding the ID of an
+  entry can index it. A discarded entry leaves its ID unused.
+*/
+struct symbol_entry* insert_entry(const char* name, int value,
+                                  enum SYMBOLTYPES type,
+                                  unsigned char* inserted){
+  _Atomic(struct symbol_entry*)* bucket;
+  struct symbol_entry* head;
+  struct symbol_entry* found;
+  struct symbol_entry* newentry = NULL;
+  symbol_slot* slot;
+  unsigned hash;
+
+  if((found = (struct symbol_entry*)register_entry(name))){
+    *inserted = FALSE;
+    return found;
+  }
+  hash = hash_name(name);
+  bucket = &buckets[hash & (SYMBOL_BUCKETS - 1)];
+  head = atomic_load_explicit(bucket, memory_order_acquire);
+  for(;;){
+    if((found = find_in_chain(head, name, hash))){
+      if(newentry){
+        atomic_store_explicit(slot, NULL, memory_order_relaxed);
+        free(newentry);
+      }
+      *inserted = FALSE;
+      return found;
+    }
+    if(!newentry){
+      newentry = malloc(sizeof(struct symbol_entry));
+      newentry->id = atomic_fetch_add(&next_id, 1);
+      if(newentry->id >= SYMBOL_CHUNK*SYMBOL_CHUNKS){
+        printf("INTERNAL ERROR: Symbol Table is full.\n");
+        exit(1);
+      }
+      strncpy(newentry->name, name, MAX_NAME_LEN - 1);
+      newentry->name[MAX_NAME_LEN - 1] = NUL;
+      newentry->hash = hash;
+      atomic_init(&newentry->value, value);
+      atomic_init(&newentry->type, type);
+      atomic_init(&newentry->claimed, type != UNKTYPE);
+      atomic_init(&newentry->fixups, type == UNKTYPE ? NULL : FIXUPS_CLOSED);
+      newentry->pending = NULL;
+      newentry->anchor = NO_RECORD;
+      slot = id_slot(newentry->id);
+      atomic_store_explicit(slot, newentry, memory_order_release);
+    }
+    newentry->next = head;
+    if(atomic_compare_exchange_weak_explicit(bucket, &head, newentry,
+                         memory_order_release, memory_order_acquire)){
+      atomic_fetch_add_explicit(&symbol_total, 1, memory_order_relaxed);
+      *inserted = TRUE;
+      return newentry;
+    }
+  }
+}
+
+/*
+  Adds an entry unless the name is already in the table, in which case the
+  existing entry is left as it is.
 */
 void add_entry(char *name, int value, enum SYMBOLTYPES type){
-  struct symbol_entry *newentry;
-  newentry = malloc(sizeof(struct symbol_entry));
+  unsigned char inserted;
+
   if(value <= MAX_LC){
-    strcpy(newentry -> name, name);
-    newentry -> value = value;
-    newentry -> type = type;
-    newentry -> next = entry;
-    entry = newentry;
+    insert_entry(name, value, type, &inserted);
   }
   else{
   error_count("ERROR: Value added to table is out of bounds", NULL);
@@ -68,24 +268,75 @@ void add_entry(char *name, int value, enum SYMBOLTYPES type){
 
 /*
   This function searches the symbol table for a label name.
-  Returns the entry of NULL if none matching.
+  Returns the entry of NULL if none matching. Registers are checked first and
+  their entries must not be written to.
 */
 struct symbol_entry *get_entry(char *name){
-  struct symbol_entry *stptr = entry;
+  struct symbol_entry* reg;
+  unsigned hash;
 
   if(name){
-    while (stptr){
-      if (strcmp(stptr -> name, name) == 0){  //Case snstv string comparison
-        return stptr;
-      }
-      else{
-        stptr = stptr -> next;
-      }
+    if((reg = (struct symbol_entry*)register_entry(name))){
+      return reg;
     }
+    hash = hash_name(name);
+    return find_in_chain(atomic_load_explicit(
+                         &buckets[hash & (SYMBOL_BUCKETS - 1)],
+                         memory_order_acquire), name, hash);
   }
   return NULL;  /* Not in symtbl */
 }
 
+/*
+  Defines name as a label of the given value. A forward reference gets
+  resolved, but only one definition of a name can ever succeed: whoever claims
+  the entry first stores its value, later definitions, from this thread or any
+  other, get DEF_DUPLICATE. The value is stored before the type so a reader
+  seeing LBLTYPE also sees the value. anchor is only read once the first pass
+  is over.
+*/
+enum DEFINE_RESULT define_entry(char* name, int value, unsigned anchor){
+  struct symbol_entry* stptr;
+  unsigned char inserted;
+  unsigned char unclaimed = FALSE;
+
+  stptr = insert_entry(name, value, LBLTYPE, &inserted);
+  if(inserted){
+    stptr->anchor = anchor;
+    return DEF_NEW;
+  }
+  if(stptr->type == REGTYPE){       // Read only, already defined
+    return DEF_DUPLICATE;
+  }
+  if(atomic_compare_exchange_strong(&stptr->claimed, &unclaimed, TRUE)){
+    stptr->anchor = anchor;
+    atomic_store_explicit(&stptr->value, value, memory_order_relaxed);
+    atomic_store_explicit(&stptr->type, LBLTYPE, memory_order_release);
+    resolve_fixups(stptr);
+    return DEF_RESOLVED;
+  }
+  return DEF_DUPLICATE;
+}
+
+/*
+  Defines the label of a record, reporting a second definition of the same
+  name. anchor is the index of the record at the label, the one following it
+  when the label has a line of its own, or NO_RECORD if the value is not an
+  address. The label then moves with its record, see relax_jumps(). Returns
+  FALSE if the label could not be defined.
+*/
+unsigned char define_label(char* name, int value, unsigned anchor){
+  if(value > MAX_LC){
+    error_count("ERROR: Value added to table is out of bounds", NULL);
+    return FALSE;
+  }
+  if(define_entry(name, value, anchor) == DEF_DUPLICATE){
+    error_count("ERROR: Label defined more than once:", name);
+    return FALSE;
+  }
+  return TRUE;
+}
+
 /*
   This function updates entries in the Symbol Table, specifically their values
   and types. Names cannot be changed.
@@ -93,25 +344,136 @@ struct symbol_entry *get_entry(char *name){
 void update_entry(char* name, int value, enum SYMBOLTYPES type){
   struct symbol_entry* updatentry = get_entry(name);
 
-  if((updatentry) && (value <= MAX_LC)){
-    updatentry->value = value;
-    updatentry->type = type;
+  if((updatentry) && (updatentry->type != REGTYPE) && (value <= MAX_LC)){
+    atomic_store_explicit(&updatentry->value, value, memory_order_relaxed);
+    atomic_store_explicit(&updatentry->claimed, type != UNKTYPE,
+                          memory_order_relaxed);
+    atomic_store_explicit(&updatentry->type, type, memory_order_release);
+    if(type != UNKTYPE){
+      resolve_fixups(updatentry);
+    }
   }
   else{
     printf("INTERNAL ERROR: Symbol Table update error.\n");
   }
 }
 
+/*
+  Ties a field of record to the value of symbol id. A defined symbol patches
+  the record right away, otherwise the site joins the symbol's fixups and is
+  patched when the symbol gets defined. The first fixup of a symbol puts it on
+  the pending list for checkunknown(). If a definition closes the list while
+  the site is being added the site is patched here instead.
+*/
+void add_fixup(unsigned id, unsigned record, enum FIXUP_KIND kind){
+  struct symbol_entry* stptr = symbol_by_id(id);
+  struct symbol_entry* head;
+  struct fixup* newfix;
+  struct fixup* list;
+
+  if(stptr->type == REGTYPE){
+    list = FIXUPS_CLOSED;
+  }
+  else{
+    newfix = malloc(sizeof(struct fixup));
+    newfix->record = record;
+    newfix->kind = kind;
+    newfix->line = line_number;
+    list = atomic_load_explicit(&stptr->fixups, memory_order_acquire);
+    do{
+      if(list == FIXUPS_CLOSED){
+        free(newfix);
+        break;
+      }
+      newfix->next = list;
+    }while(!atomic_compare_exchange_weak(&stptr->fixups, &list, newfix));
+  }
+
+  if(list == FIXUPS_CLOSED){
+    if(record != NO_RECORD){
+      apply_fixup(record, kind, stptr->value);
+    }
+  }
+  else if(list == NULL){          // First fixup, only one thread can see NULL
+    head = atomic_load(&pending_symbols);
+    do{
+      stptr->pending = head;
+    }while(!atomic_compare_exchange_weak(&pending_symbols, &head, stptr));
+  }
+}
+
+/*
+  Patches every fixup of a symbol which has just been defined and closes its
+  list, so later uses are patched as they are added.
+*/
+void resolve_fixups(struct symbol_entry* stptr){
+  struct fixup* list = atomic_exchange(&stptr->fixups, FIXUPS_CLOSED);
+  struct fixup* next;
+
+  if(list == FIXUPS_CLOSED){
+    return;
+  }
+  while(list){
+    next = list->next;
+    if(list->record != NO_RECORD){
+      apply_fixup(list->record, list->kind, stptr->value);
+    }
+    free(list);
+    list = next;
+  }
+}
+
+/* Orders entries by name */
+int compare_names(const void* a, const void* b){
+  return strcmp((*(struct symbol_entry* const*)a)->name,
+                (*(struct symbol_entry* const*)b)->name);
+}
+
+/*
+  Every entry of the table, registers included, sorted by name so that
+  listings do not depend on the hashing or on the order in which threads
+  inserted. The entries are only to be read. The caller frees the returned
+  array.
+*/
+struct symbol_entry** sorted_entries(unsigned* count){
+  struct symbol_entry** list;
+  struct symbol_entry* stptr;
+  unsigned total = atomic_load(&symbol_total);
+  unsigned i = 0;
+  unsigned b;
+
+  list = malloc(sizeof(struct symbol_entry*)*(total + REG_COUNT+REG_ALIASES));
+  for(; i < REG_COUNT + REG_ALIASES; i++){
+    list[i] = (struct symbol_entry*)&registers[i];
+  }
+  total += REG_COUNT + REG_ALIASES;
+  for(b = 0; b < SYMBOL_BUCKETS; b++){
+    stptr = atomic_load_explicit(&buckets[b], memory_order_acquire);
+    for(; stptr && i < total; stptr = stptr->next){
+      list[i++] = stptr;
+    }
+  }
+  qsort(list, i, sizeof(struct symbol_entry*), compare_names);
+  *count = i;
+  return list;
+}
+
 /*
   This function prints the symbol table in the terminal and to the diagnostics
   file.
 */
 void print_symboltable(void){
-  struct symbol_entry* printentry = entry;
-  if(printentry != NULL){
+  struct symbol_entry** list;
+  struct symbol_entry* printentry;
+  unsigned count;
+  unsigned i;
+
+  list = sorted_entries(&count);
+  if(count){
     printf("\n--------------    Symbol Table    --------------\n");
     fprintf(fout, "\n--------------    Symbol Table    --------------\n");
-    while(printentry != NULL){
+    for(i = 0; i < count; i++){
+      printentry = list[i];
       printf("Name: %s \t Value: %d \t Type: ", printentry -> name,
               printentry -> value);
       fprintf(fout, "Name: %s\t\tValue: %d\t\tType: ", printentry -> name,
@@ -134,42 +496,129 @@ void print_symboltable(void){
         fprintf(fout, "Illegal Type\n");
         break;
       }
-      printentry = printentry -> next;
     }
   }
   else{
     printf("The Symbol Table has no entries.\n");
     fprintf(fout, "The Symbol Table has no entries.\n");
   }
+  free(list);
 }
 
-/* This function deletes the latest entry in the symbol table */
-void delete_entry(void){
-  struct symbol_entry *oldentry = entry;
-  free(oldentry);         // Release memory
-  entry = entry -> next;  // Update to the next existing node
-}
-
-/* This function clears the whole symbol table */
+/*
+  This function clears the whole symbol table. No other thread may be using
+  the table at this point.
+*/
 void clear_table(void){
-  struct symbol_entry *oldentry = entry;
-  while(oldentry){
-    delete_entry();
-    oldentry = entry;     // Update to the next existing node
+  struct symbol_entry *oldentry;
+  struct symbol_entry *nextentry;
+  struct fixup *fix;
+  struct fixup *nextfix;
+  unsigned b;
+
+  for(b = 0; b < SYMBOL_BUCKETS; b++){
+    oldentry = atomic_exchange(&buckets[b], NULL);
+    while(oldentry){
+      nextentry = oldentry->next;
+      fix = atomic_load(&oldentry->fixups);
+      while(fix && fix != FIXUPS_CLOSED){   // Of undefined symbols
+        nextfix = fix->next;
+        free(fix);
+        fix = nextfix;
+      }
+      free(oldentry);         // Release memory
+      oldentry = nextentry;
+    }
+  }
+  for(b = 0; b < SYMBOL_CHUNKS; b++){
+    free(atomic_exchange(&id_chunks[b], NULL));
   }
+  atomic_store(&next_id, REG_COUNT + REG_ALIASES);
+  atomic_store(&pending_symbols, NULL);
+  atomic_store(&symbol_total, 0);
 }
 
+/*
+  Reports every label still undefined, in name order, with the lines using it.
+  Only the symbols which had fixups are looked at, a symbol is never unknown
+  without one.
+*/
 unsigned char checkunknown(void){
-  struct symbol_entry *stptr = entry;
-  unsigned char res = FALSE;
+  struct symbol_entry** list;
+  struct symbol_entry* stptr;
+  struct fixup* fix;
+  struct fixup* prev;
+  struct fixup* next;
+  unsigned count = 0;
+  unsigned i;
 
-  while(stptr != NULL){
-    if(stptr->type == UNKTYPE){
-      printf("ERROR: Undeclared Label %s\n", stptr->name);
-      fprintf(fout, "ERROR: Undeclared Label %s\n", stptr->name);
-      res = TRUE;
+  for(stptr = atomic_load(&pending_symbols); stptr; stptr = stptr->pending){
+    count++;
+  }
+  list = malloc(sizeof(struct symbol_entry*)*(count + 1));
+  count = 0;
+  for(stptr = atomic_load(&pending_symbols); stptr; stptr = stptr->pending){
+    if(atomic_load(&stptr->fixups) != FIXUPS_CLOSED){
+      list[count++] = stptr;
+    }
+  }
+  qsort(list, count, sizeof(struct symbol_entry*), compare_names);
+
+  for(i = 0; i < count; i++){
+    printf("ERROR: Undeclared Label %s\n", list[i]->name);
+    fprintf(fout, "ERROR: Undeclared Label %s\n", list[i]->name);
+
+    // The newest use is first, turn the list around to print them in order
+    prev = NULL;
+    for(fix = atomic_load(&list[i]->fixups); fix; fix = next){
+      next = fix->next;
+      fix->next = prev;
+      prev = fix;
+    }
+    atomic_store(&list[i]->fixups, prev);
+    fprintf(fout, "Used on line(s):");
+    for(fix = prev; fix; fix = fix->next){
+      fprintf(fout, " %u", fix->line);
+    }
+    fprintf(fout, "\n");
+  }
+  free(list);
+  return count != 0;
+}
+
+/* Orders labels by value, then by name for labels sharing a value */
+int compare_symbols(const void* a, const void* b){
+  const struct symbol_entry* sa = a;
+  const struct symbol_entry* sb = b;
+
+  if(sa->value != sb->value){
+    return sa->value - sb->value;
+  }
+  return strcmp(sa->name, sb->name);
+}
+
+/*
+  Copies every label of the symbol table into an array sorted by value, so the
+  output writers do not depend on the table itself. Registers are left out.
+  The caller owns the returned array.
+*/
+struct symbol_entry* snapshot_symboltable(unsigned* count){
+  struct symbol_entry** list;
+  struct symbol_entry* snapshot;
+  unsigned total;
+  unsigned i = 0;
+  unsigned j;
+
+  list = sorted_entries(&total);
+  snapshot = malloc(sizeof(struct symbol_entry)*(total + 1));
+  for(j = 0; j < total; j++){
+    if(list[j]->type == LBLTYPE){
+      snapshot[i] = *list[j];
+      snapshot[i++].next = NULL;
     }
-    stptr = stptr->next;
   }
-  return res;
+  free(list);
+  qsort(snapshot, i, sizeof(struct symbol_entry), compare_symbols);
+  *count = i;
+  return snapshot;
 }
@@ -8,31 +8,85 @@
 
   Coder: Elias Vonapartis, with code from ECED3403
   Release Date: May 28, 2016
-  Latest Updates: None
+  Latest Updates: Oct 19, 2026  - Concurrent hash table replaces the list
+                                - Registers in a constant table of their own
+                                - Symbols numbered with dense IDs
+                                - Register numbers of PC, SR and CG
+                                - Undefined symbols keep their fixup sites
+                                - Labels anchored to their record
 */
 
 #define MAX_LC 65535
 #define MAX_NAME_LEN 32
+#define SYMBOL_BUCKETS 4096     // Power of two
+#define REG_COUNT 16            // R0 to R15
+#define REG_ALIASES 3           // PC, SP and SR, follow R15 in the table
+#define REG_SIZE 3              // Longest register name
+#define NO_REG   -1
+#define PC_REG    0
+#define SR_REG    2
+#define CG_REG    3             // Constant generator
+#define NO_SYMBOL 0xFFFFFFFFu   // Symbol ID of an operand without a symbol
+#define SYMBOL_CHUNK  1024      // IDs per chunk of the ID array
+#define SYMBOL_CHUNKS 1024
 
 #define CONGEN(x) ((x == -1)||(x == 0)||(x == 1)||(x == 2)||(x == 4)||(x == 8))
 
 enum SYMBOLTYPES {REGTYPE, LBLTYPE, UNKTYPE};
+enum DEFINE_RESULT {DEF_NEW, DEF_RESOLVED, DEF_DUPLICATE};
+enum FIXUP_KIND {FIX_SRC, FIX_DST, FIX_JUMP};   // Field of the record to patch
+
+#define NO_RECORD 0xFFFFFFFFu   // No record, e.g. the instruction had errors
+
+/*
+  A use of a symbol which was not defined yet. Once it is, the record at offset
+  record gets the value, see apply_fixup(). record is NO_RECORD when the
+  instruction had errors and was not recorded, the use is then only kept for
+  the report of undefined symbols.
+*/
+struct fixup{
+  unsigned record;
+  enum FIXUP_KIND kind;
+  unsigned line;                  // Line of the use
+  struct fixup* next;
+};
+
+#define FIXUPS_CLOSED ((struct fixup*)1)  // Fixups of a defined symbol
 
 struct symbol_entry{
   char name[MAX_NAME_LEN];  /* Name of Symbol */
-  int value;                /* LC, Register   */
-  enum SYMBOLTYPES type;    /* Type (Register)*/
-  struct symbol_entry *next;/* Next Entry     */
+  _Atomic int value;        /* LC, Register   */
+  _Atomic enum SYMBOLTYPES type; /* Type (Register)*/
+  _Atomic unsigned char claimed; /* Defined, see define_entry() */
+  unsigned hash;            /* hash_name() of the name */
+  unsigned id;              /* Dense ID, see symbol_by_id() */
+  struct symbol_entry *next;/* Next Entry in the bucket, fixed once added */
+  _Atomic(struct fixup*) fixups; /* Uses waiting for the definition */
+  struct symbol_entry *pending;  /* Next symbol which had fixups */
+  unsigned anchor;          /* Record at the label, NO_RECORD if it is not
+                               an address, see define_label() */
 };
 
 /* Function Declarations */
-void init_symboltable(void);
 void print_symboltable(void);
+int register_number(const char* , unsigned );
+const struct symbol_entry* register_entry(const char* );
+unsigned hash_name(const char* );
+struct symbol_entry* insert_entry(const char* , int , enum SYMBOLTYPES ,
+                                  unsigned char* );
 void add_entry(char* , int , enum SYMBOLTYPES);
 struct symbol_entry* get_entry(char* );
+struct symbol_entry* symbol_by_id(unsigned );
+const char* symbol_name(unsigned );
+enum DEFINE_RESULT define_entry(char* , int , unsigned );
+unsigned char define_label(char* , int , unsigned );
+unsigned symbol_limit(void);
 void update_entry(char* , int , enum SYMBOLTYPES);
-void delete_entry(void);
+void add_fixup(unsigned , unsigned , enum FIXUP_KIND );
+void resolve_fixups(struct symbol_entry* );
+struct symbol_entry** sorted_entries(unsigned* );
 void clear_table(void);
 unsigned char checkunknown(void);
+struct symbol_entry* snapshot_symboltable(unsigned* );
 
 #endif /* SYMBOLTABLE_H */